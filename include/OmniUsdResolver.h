@@ -11,6 +11,7 @@
 
 #include "Defines.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -85,3 +86,429 @@ OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetCheckpointMessage(const char* mes
  */
 OMNIUSDRESOLVER_EXPORT(void)
 omniUsdResolverSetMdlBuiltins(char const** builtins, size_t numBuiltins) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Index MDL search roots in the background.
+ *
+ * Every .mdl module found under the roots is added to the built-in MDLs along with what it resolves to, so
+ * resolving it does not require a round trip to the server. Roots are searched in order, so a module found under
+ * an earlier root wins. Calling this again replaces the previous index and an empty list removes it.
+ * The initial roots can also be set with the OMNI_USD_RESOLVER_MDL_INDEX_ROOTS environment variable.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverIndexMdlSearchRoots(char const** roots, size_t numRoots) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Wait for the MDL search roots started with omniUsdResolverIndexMdlSearchRoots to finish indexing.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverWaitForMdlIndex() OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Enable or disable the process-wide resolve cache.
+ *
+ * The process-wide cache sits behind any cache created with ArResolverScopedCache, so resolves made outside of a
+ * cache scope do not need to go through the client-library every time. Only successful resolves are cached and each
+ * entry expires according to the time-to-live configured for its scheme (see omniUsdResolverSetGlobalCacheTtl).
+ *
+ * The cache is disabled by default unless the environment variable OMNI_USD_RESOLVER_GLOBAL_CACHE is set.
+ *
+ * @param enabled true to enable the process-wide cache, false to disable it.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetGlobalCacheEnabled(bool enabled) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set how long resolves for URLs with the given scheme are kept in the process-wide resolve cache.
+ *
+ * Local file paths use the "file" scheme and "*" (or nullptr) applies to any scheme that has not been explicitly set.
+ * The defaults can be set with the environment variable OMNI_USD_RESOLVER_GLOBAL_CACHE_TTL, i.e "*=30,file=5".
+ * The new time-to-live only applies to entries added after this call.
+ *
+ * @param scheme The URL scheme, i.e "omniverse" or "https".
+ * @param seconds The time-to-live in seconds. Zero prevents resolves for the scheme from being cached.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetGlobalCacheTtl(const char* scheme, double seconds) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Flush all resolves cached in the process-wide resolve cache, the search path cache and the resolve index.
+ * Downloads started by omniUsdResolverPrefetch that have not been opened are stopped and cached USDZ packages are
+ * released.
+ *
+ * Caches created with ArResolverScopedCache are not affected as their lifetime is controlled by the cache scope.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverFlushCache() OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set the file used to persist successful resolves across processes.
+ *
+ * Anything resolved since the current resolve index was last saved is written to it first. The new file is
+ * memory-mapped the next time a resolve misses the resolve caches. Only absolute identifiers are stored in the index,
+ * since relative identifiers resolve differently depending on the bound context. The initial file and staleness can
+ * be set with the environment variables OMNI_USD_RESOLVER_RESOLVE_INDEX and OMNI_USD_RESOLVER_RESOLVE_INDEX_STALENESS.
+ *
+ * @param path Path to the index file. nullptr or an empty string disables the resolve index.
+ * @param stalenessSeconds How long after it was resolved an entry in the index is trusted without resolving it again.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetResolveIndex(const char* path, double stalenessSeconds) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Write what this process resolved to the resolve index file now.
+ *
+ * The index is also saved when the resolver is destroyed, and every OMNI_USD_RESOLVER_RESOLVE_INDEX_SAVE_INTERVAL
+ * seconds (60 by default) while resolves are added to it. Processes that exit without destroying the resolver, i.e
+ * through _exit, should call this before exiting.
+ *
+ * @return false if no resolve index is set or it could not be written.
+ */
+OMNIUSDRESOLVER_EXPORT(bool) omniUsdResolverSaveResolveIndex() OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set how long a search path that failed to resolve next to the layer referencing it is remembered.
+ *
+ * When creating an identifier for a search path, i.e "Materials/Base.mdl", the search path is first anchored to the
+ * directory of the layer referencing it ("look here first"). Failed probes are remembered per anchor directory so
+ * that other layers in the same directory do not need to ask the server again. Writing an asset through the resolver
+ * invalidates the misses for the directories that contain it.
+ *
+ * The search path cache is disabled by default unless the environment variable
+ * OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_TTL is set. The number of entries is bounded by
+ * OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_SIZE.
+ *
+ * @param seconds The time-to-live in seconds. Zero disables, and clears, the search path cache.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetSearchPathCacheTtl(double seconds) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * The result of resolving a single identifier with omniUsdResolverResolveBatch.
+ *
+ * All strings are owned by the resolver and are only valid for the duration of the callback.
+ */
+struct OmniUsdResolverResolveResult
+{
+    /// The identifier that was resolved
+    const char* identifier;
+
+    /// The resolved path. This is an empty string if the identifier could not be resolved
+    const char* resolvedPath;
+
+    /// The URL that the identifier was resolved to
+    const char* url;
+
+    /// The version that was resolved, if the provider supports versions
+    const char* version;
+
+    /// The time the asset was last modified in nanoseconds since the Unix epoch
+    uint64_t modifiedTimeNs;
+
+    /// The size of the asset in bytes
+    uint64_t size;
+};
+
+/**
+ * Called once all identifiers passed to omniUsdResolverResolveBatch have been resolved.
+ *
+ * The results are in the same order as the identifiers.
+ */
+typedef void(OMNIUSDRESOLVER_ABI* OmniUsdResolverResolveBatchCallback)(void* userData,
+                                                                      const struct OmniUsdResolverResolveResult* results,
+                                                                      size_t count) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Resolve a list of identifiers concurrently.
+ *
+ * Every resolve is issued before waiting on any of them, so a batch costs roughly one round trip to the server instead
+ * of one round trip per identifier. The results are added to the ArResolverScopedCache that is active on the calling
+ * thread, and to the process-wide cache if it is enabled, so tools that know their dependencies up front can warm the
+ * cache before opening a stage. This function blocks until all identifiers have been resolved.
+ *
+ * @param identifiers The asset identifiers to resolve, i.e the result of ArResolver::CreateIdentifier.
+ * @param count The number of identifiers.
+ * @param userData Passed to the callback.
+ * @param callback Called with the results before this function returns. Can be nullptr to only warm the cache.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverResolveBatch(const char** identifiers,
+                            size_t count,
+                            void* userData,
+                            OmniUsdResolverResolveBatchCallback callback) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set the approximate number of bytes each resolve cache may use before entries are evicted.
+ *
+ * The budget applies separately to every ArResolverScopedCache and to the process-wide cache. When a cache goes over
+ * budget the least recently looked up entries are evicted first, using the CLOCK (second chance) policy. The initial
+ * budget can be set with the environment variable OMNI_USD_RESOLVER_CACHE_BUDGET.
+ *
+ * @param bytes The budget in bytes. Zero, the default, means the caches are unbounded.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetCacheBudget(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Return the approximate number of bytes used by the process-wide resolve cache and the ArResolverScopedCache that is
+ * active on the calling thread.
+ */
+OMNIUSDRESOLVER_EXPORT(size_t) omniUsdResolverGetCacheFootprint() OMNIUSDRESOLVER_NOEXCEPT;
+
+enum OmniUsdResolverCacheTier
+{
+    /// The ArResolverScopedCache that is active on the calling thread
+    eOmniUsdResolverCacheTier_Scoped,
+
+    /// The process-wide resolve cache
+    eOmniUsdResolverCacheTier_Global,
+
+    Count_eOmniUsdResolverCacheTier
+};
+
+/**
+ * Counters describing how effective a resolve cache is.
+ */
+struct OmniUsdResolverCacheStats
+{
+    /// Number of lookups that found an entry
+    uint64_t hits;
+
+    /// Number of lookups that did not find an entry
+    uint64_t misses;
+
+    /// Number of entries added
+    uint64_t inserts;
+
+    /// Number of entries removed because the asset was written
+    uint64_t removes;
+
+    /// Number of entries evicted to stay within the cache budget (see omniUsdResolverSetCacheBudget)
+    uint64_t evictions;
+
+    /// Number of entries currently in the cache
+    uint64_t entries;
+
+    /// Approximate number of bytes currently used by the cache
+    uint64_t bytes;
+};
+
+/**
+ * Get the counters for a resolve cache.
+ *
+ * @param tier The cache to get the counters for.
+ * @param stats Filled in with the counters.
+ * @return false if there is no cache for the tier, i.e no ArResolverScopedCache is active on the calling thread.
+ */
+OMNIUSDRESOLVER_EXPORT(bool)
+omniUsdResolverGetCacheStats(OmniUsdResolverCacheTier tier,
+                             struct OmniUsdResolverCacheStats* stats) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Called for each key returned by omniUsdResolverGetHottestCacheKeys.
+ */
+typedef void(OMNIUSDRESOLVER_ABI* OmniUsdResolverCacheKeyCallback)(void* userData,
+                                                                   const char* key,
+                                                                   uint64_t hits) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Get the keys in a resolve cache with the most hits.
+ *
+ * The callback is called once per key, ordered from most to least hits, before this function returns.
+ *
+ * @param tier The cache to get the keys from.
+ * @param count The maximum number of keys.
+ * @param userData Passed to the callback.
+ * @param callback Called for each key.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverGetHottestCacheKeys(OmniUsdResolverCacheTier tier,
+                                   size_t count,
+                                   void* userData,
+                                   OmniUsdResolverCacheKeyCallback callback) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Called to read a range of bytes from a remote asset.
+ *
+ * @param userData The userData passed to omniUsdResolverSetRangeReader.
+ * @param url The resolved path of the asset.
+ * @param offset The offset of the first byte to read.
+ * @param buffer Filled in with the bytes that were read.
+ * @param count The number of bytes to read.
+ * @return The number of bytes read, which is only less than count at the end of the asset, or -1 on failure.
+ */
+typedef int64_t(OMNIUSDRESOLVER_ABI* OmniUsdResolverRangeReadCallback)(void* userData,
+                                                                      const char* url,
+                                                                      uint64_t offset,
+                                                                      void* buffer,
+                                                                      uint64_t count) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Register a function used to read remote assets while they are being downloaded.
+ *
+ * By default a remote asset can not be read until all of it has been downloaded to the local cache. When a range
+ * reader is registered, assets of at least minimumSize bytes are downloaded in the background instead, and reads are
+ * served by the range reader, through a cache of blocks, until the download has finished. The client library does not
+ * support ranged reads, so the range reader would typically issue HTTP range requests to the server. The block size
+ * and the number of cached blocks can be set with the environment variables OMNI_USD_RESOLVER_STREAMING_BLOCK_SIZE and
+ * OMNI_USD_RESOLVER_STREAMING_CACHE_BLOCKS.
+ *
+ * Assets that are already open keep using the range reader they were opened with, so userData must remain valid until
+ * they are destroyed.
+ *
+ * @param userData Passed to the callback.
+ * @param callback Called to read a range of bytes. Can be nullptr to disable streaming reads.
+ * @param minimumSize Assets smaller than this number of bytes are downloaded before they are read.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetRangeReader(void* userData,
+                              OmniUsdResolverRangeReadCallback callback,
+                              uint64_t minimumSize) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Start downloading assets that are about to be opened.
+ *
+ * Opening a remote asset waits for it to be downloaded to the local cache, so opening many assets one after the other
+ * waits for one download at a time. Prefetching starts the downloads in the background, with at most
+ * OMNI_USD_RESOLVER_PREFETCH_PARALLELISM (16 by default) downloads running at once and higher priorities started
+ * first. The first time a prefetched asset is opened it takes over the download, waiting for it if it has not finished
+ * yet. A download that has not started when the asset is opened is dropped from the queue. This function returns
+ * immediately.
+ *
+ * Prefetched downloads that are never opened are kept until omniUsdResolverFlushCache is called or the asset is
+ * written. At most OMNI_USD_RESOLVER_PREFETCH_CACHE_SIZE (1024 by default) finished downloads are kept, beyond which
+ * the oldest ones are stopped and opening them downloads them again.
+ *
+ * @param urls The resolved paths of the assets, i.e the result of ArResolver::Resolve. Local paths are ignored.
+ * @param count The number of URLs.
+ * @param priority Downloads with a higher priority are started first. Prefetching a URL that is still queued again
+ *                 with a higher priority moves it up the queue.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverPrefetch(const char** urls, size_t count, int32_t priority) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set the size below which remote assets are read into memory when they are opened.
+ *
+ * Every opened asset otherwise keeps its local file open, and its download request alive, until it is destroyed. A
+ * stage with many small layers and materials can run out of file descriptors. Assets smaller than this size are read
+ * into a pooled memory buffer when they are opened instead, and the local file and request are released right away.
+ * ArAsset::GetBuffer returns that buffer without a copy. The initial size can be set with the environment variable
+ * OMNI_USD_RESOLVER_IN_MEMORY_ASSET_SIZE.
+ *
+ * @param bytes The size in bytes. Zero, the default, disables reading assets into memory.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetInMemoryAssetSize(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Set the maximum number of bytes read ahead when an asset is read sequentially.
+ *
+ * Small reads that continue where the previous read ended are then served from a per-asset buffer, which saves a
+ * round trip per read when the local cache directory is on network storage. The buffer is released when the asset
+ * stops reading sequentially. Crate files are never read ahead. The initial size can be set with the environment
+ * variable OMNI_USD_RESOLVER_READ_AHEAD_SIZE.
+ *
+ * @param bytes The size in bytes. Zero, the default, disables read-ahead.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetReadAheadSize(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Enable or disable reading local files with io_uring on Linux.
+ *
+ * Large reads are split into ranges that are all submitted to a single io_uring shared by every thread, so the kernel
+ * can read them in parallel. Other reads are still issued with pread. If io_uring is not available, reads fall back to
+ * pread. This has no effect on other platforms. The initial value can be set with the environment variable
+ * OMNI_USD_RESOLVER_IO_URING.
+ *
+ * @param enabled Whether io_uring is used. It is disabled by default.
+ */
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetIoUringEnabled(bool enabled) OMNIUSDRESOLVER_NOEXCEPT;
+
+/**
+ * Called to start uploading an asset that was opened for writing.
+ *
+ * @param userData The userData of the OmniUsdResolverUploadSink.
+ * @param url The resolved path of the asset.
+ * @return A handle for the upload that is passed to the other callbacks, or nullptr to write the asset without
+ *         streaming it.
+ */
+typedef void*(OMNIUSDRESOLVER_ABI* OmniUsdResolverUploadBeginCallback)(void* userData,
+                                                                       const char* url) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Called to upload a chunk of an asset.
+ *
+ * Chunks are uploaded in order while the asset is being written. A chunk that is written to again after it has been
+ * uploaded is uploaded again before the upload is committed, replacing the content that was uploaded at its offset.
+ *
+ * @param userData The userData of the OmniUsdResolverUploadSink.
+ * @param upload The handle returned by the begin callback.
+ * @param offset The offset of the chunk in the asset.
+ * @param buffer The content of the chunk.
+ * @param count The number of bytes in the chunk.
+ * @return false if the chunk could not be uploaded.
+ */
+typedef bool(OMNIUSDRESOLVER_ABI* OmniUsdResolverUploadChunkCallback)(void* userData,
+                                                                      void* upload,
+                                                                      uint64_t offset,
+                                                                      const void* buffer,
+                                                                      uint64_t count) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Called once every chunk of an asset has been uploaded to make the asset available at its URL.
+ *
+ * @param userData The userData of the OmniUsdResolverUploadSink.
+ * @param upload The handle returned by the begin callback.
+ * @param size The size of the asset in bytes.
+ * @param message The checkpoint message, see omniUsdResolverSetCheckpointMessage.
+ * @return false if the asset could not be committed, in which case the upload is aborted.
+ */
+typedef bool(OMNIUSDRESOLVER_ABI* OmniUsdResolverUploadCommitCallback)(void* userData,
+                                                                       void* upload,
+                                                                       uint64_t size,
+                                                                       const char* message)
+    OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Called to discard an upload that will not be committed. The handle is not used after this is called.
+ *
+ * @param userData The userData of the OmniUsdResolverUploadSink.
+ * @param upload The handle returned by the begin callback.
+ */
+typedef void(OMNIUSDRESOLVER_ABI* OmniUsdResolverUploadAbortCallback)(void* userData,
+                                                                      void* upload) OMNIUSDRESOLVER_CALLBACK_NOEXCEPT;
+
+/**
+ * Functions used to upload assets while they are being written.
+ */
+struct OmniUsdResolverUploadSink
+{
+    /// Passed to the callbacks
+    void* userData;
+
+    /// Called when an asset is opened for writing
+    OmniUsdResolverUploadBeginCallback begin;
+
+    /// Called for each chunk of the asset. Chunks written before the asset is closed are uploaded on a background thread
+    OmniUsdResolverUploadChunkCallback chunk;
+
+    /// Called when the asset is closed
+    OmniUsdResolverUploadCommitCallback commit;
+
+    /// Called if the asset fails to be written, or is destroyed without being closed
+    OmniUsdResolverUploadAbortCallback abort;
+};
+
+/**
+ * Register functions used to upload assets while they are being written.
+ *
+ * By default an asset opened for writing is written to a temporary file which is moved to the server when the asset is
+ * closed, so the upload does not start until the last byte has been written. When an upload sink is registered, assets
+ * opened with ArResolver::WriteMode::Replace are uploaded in chunks on a background thread as soon as each chunk has
+ * been written, and closing the asset only uploads what is left before committing it. The client library does not
+ * support chunked uploads, so the sink would typically use a multi-part upload API of the server. If the upload fails
+ * it is aborted and the temporary file is moved to the server instead.
+ *
+ * Assets that are already open keep using the sink they were opened with, so userData must remain valid until they
+ * are closed or destroyed.
+ *
+ * @param sink The functions used to upload assets. Can be nullptr to disable streaming uploads.
+ * @param chunkSize The number of bytes in each chunk, except for the last one. Zero uses 8 MiB.
+ */
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetUploadSink(const struct OmniUsdResolverUploadSink* sink, uint64_t chunkSize) OMNIUSDRESOLVER_NOEXCEPT;
@@ -64,6 +64,12 @@ PYBIND11_MODULE(_omni_usd_resolver, m)
         .value("FAILURE", eOmniUsdResolverEventState_Failure)
         .attr("__module__") = "omni.usd_resolver";
 
+    static_assert(Count_eOmniUsdResolverCacheTier == 2, "Missing entries");
+    py::enum_<OmniUsdResolverCacheTier>(m, "CacheTier", R"()")
+        .value("SCOPED", eOmniUsdResolverCacheTier_Scoped)
+        .value("GLOBAL", eOmniUsdResolverCacheTier_Global)
+        .attr("__module__") = "omni.usd_resolver";
+
     py::class_<Subscription, std::shared_ptr<Subscription>>(m, "Subscription")
         .def(
             "__enter__", [&](std::shared_ptr<Subscription> sub) { return sub; }, py::call_guard<py::gil_scoped_release>())
@@ -141,4 +147,294 @@ PYBIND11_MODULE(_omni_usd_resolver, m)
 
             Resolving an MDL in this list will return immediately rather than performing a full resolution.
         )");
+
+    m.def(
+        "index_mdl_search_roots",
+        [](std::vector<std::string> const& roots)
+        {
+            std::vector<char const*> roots_cstr;
+            roots_cstr.resize(roots.size());
+            for (size_t i = 0; i < roots.size(); i++)
+            {
+                roots_cstr[i] = roots[i].c_str();
+            }
+            omniUsdResolverIndexMdlSearchRoots(roots_cstr.data(), roots_cstr.size());
+        },
+        py::call_guard<py::gil_scoped_release>(),
+        R"(
+            Index MDL search roots in the background.
+
+            Every MDL found under the roots is added to the built-in MDLs along with what it resolves to.
+            Roots are searched in order. An empty list removes the index.
+        )");
+
+    m.def("wait_for_mdl_index", &omniUsdResolverWaitForMdlIndex, py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Wait for the MDL search roots passed to index_mdl_search_roots to finish indexing.
+        )");
+
+    m.def(
+        "prefetch",
+        [](std::vector<std::string> const& urls, int32_t priority)
+        {
+            std::vector<char const*> urls_cstr;
+            urls_cstr.resize(urls.size());
+            for (size_t i = 0; i < urls.size(); i++)
+            {
+                urls_cstr[i] = urls[i].c_str();
+            }
+            omniUsdResolverPrefetch(urls_cstr.data(), urls_cstr.size(), priority);
+        },
+        py::arg("urls"), py::arg("priority") = 0, py::call_guard<py::gil_scoped_release>(),
+        R"(
+            Start downloading assets that are about to be opened.
+
+            Downloads run in the background, a bounded number at a time, with higher priorities started first.
+            Opening a prefetched asset waits for its download instead of starting another one.
+
+            Args:
+                urls (list[str]): The resolved paths of the assets.
+                priority (int): Downloads with a higher priority are started first.
+        )");
+
+    m.def(
+        "resolve_batch",
+        [](std::vector<std::string> const& identifiers)
+        {
+            struct Result
+            {
+                std::string resolvedPath;
+                std::string url;
+                std::string version;
+                uint64_t modifiedTimeNs;
+                uint64_t size;
+            };
+            std::vector<Result> results;
+
+            {
+                py::gil_scoped_release release;
+
+                std::vector<char const*> identifiers_cstr;
+                identifiers_cstr.resize(identifiers.size());
+                for (size_t i = 0; i < identifiers.size(); i++)
+                {
+                    identifiers_cstr[i] = identifiers[i].c_str();
+                }
+                omniUsdResolverResolveBatch(
+                    identifiers_cstr.data(), identifiers_cstr.size(), &results,
+                    [](void* userData, const OmniUsdResolverResolveResult* batch, size_t count) noexcept
+                    {
+                        auto& results = *static_cast<std::vector<Result>*>(userData);
+                        for (size_t i = 0; i < count; i++)
+                        {
+                            results.push_back({ batch[i].resolvedPath, batch[i].url, batch[i].version,
+                                                batch[i].modifiedTimeNs, batch[i].size });
+                        }
+                    });
+            }
+
+            py::list list;
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                py::dict d;
+                d["identifier"] = identifiers[i];
+                d["resolved_path"] = results[i].resolvedPath;
+                d["url"] = results[i].url;
+                d["version"] = results[i].version;
+                d["modified_time_ns"] = results[i].modifiedTimeNs;
+                d["size"] = results[i].size;
+                list.append(d);
+            }
+            return list;
+        },
+        py::arg("identifiers"),
+        R"(
+            Resolve a list of identifiers concurrently.
+
+            All resolves are issued before waiting on any of them. The results are added to the active
+            Ar.ResolverScopedCache and to the process-wide cache if it is enabled.
+
+            Args:
+                identifiers (list[str]): The asset identifiers to resolve.
+
+            Returns:
+                A list of dictionaries, in the same order as identifiers, with the keys "identifier", "resolved_path",
+                "url", "version", "modified_time_ns" and "size". "resolved_path" is empty if the identifier could not
+                be resolved.
+        )");
+
+    m.def("set_global_cache_enabled", &omniUsdResolverSetGlobalCacheEnabled, py::arg("enabled"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Enable or disable the process-wide resolve cache.
+
+            The process-wide cache is used for resolves made outside of an Ar.ResolverScopedCache.
+
+            Args:
+                enabled (bool): True to enable the process-wide cache.
+        )");
+
+    m.def("set_global_cache_ttl", &omniUsdResolverSetGlobalCacheTtl, py::arg("scheme"), py::arg("seconds"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Set how long resolves for URLs with the given scheme are kept in the process-wide resolve cache.
+
+            Args:
+                scheme (str): The URL scheme. Local file paths use "file" and "*" applies to all other schemes.
+                seconds (float): The time-to-live in seconds. Zero prevents the scheme from being cached.
+        )");
+
+    m.def("flush_cache", &omniUsdResolverFlushCache, py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Flush all resolves cached in the process-wide resolve cache and the search path cache.
+        )");
+
+    m.def(
+        "set_resolve_index",
+        [](const std::string& path, double stalenessSeconds)
+        { omniUsdResolverSetResolveIndex(path.c_str(), stalenessSeconds); },
+        py::arg("path"), py::arg("staleness_seconds") = 600.0, py::call_guard<py::gil_scoped_release>(),
+        R"(
+            Set the file used to persist successful resolves across processes.
+
+            Anything resolved since the current resolve index was last saved is written to it first.
+
+            Args:
+                path (str): Path to the index file. An empty string disables the resolve index.
+                staleness_seconds (float): How long an entry in the index is trusted without resolving it again.
+        )");
+
+    m.def("save_resolve_index", &omniUsdResolverSaveResolveIndex, py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Write what this process resolved to the resolve index file now.
+
+            Returns:
+                False if no resolve index is set or it could not be written.
+        )");
+
+    m.def("set_cache_budget", &omniUsdResolverSetCacheBudget, py::arg("bytes"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Set the approximate number of bytes each resolve cache may use before entries are evicted.
+
+            Args:
+                bytes (int): The budget in bytes. Zero means the caches are unbounded.
+        )");
+
+    m.def("set_in_memory_asset_size", &omniUsdResolverSetInMemoryAssetSize, py::arg("bytes"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Set the size below which remote assets are read into memory when they are opened.
+
+            Assets read into memory release their local file and download request as soon as they are opened.
+
+            Args:
+                bytes (int): The size in bytes. Zero disables reading assets into memory.
+        )");
+
+    m.def("set_read_ahead_size", &omniUsdResolverSetReadAheadSize, py::arg("bytes"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Set the maximum number of bytes read ahead when an asset is read sequentially.
+
+            Crate files are never read ahead.
+
+            Args:
+                bytes (int): The size in bytes. Zero disables read-ahead.
+        )");
+
+    m.def("set_io_uring_enabled", &omniUsdResolverSetIoUringEnabled, py::arg("enabled"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Enable or disable reading local files with io_uring on Linux.
+
+            Large reads are split into ranges that the kernel reads in parallel. Reads fall back to pread if io_uring
+            is not available.
+
+            Args:
+                enabled (bool): Whether io_uring is used.
+        )");
+
+    m.def("get_cache_footprint", &omniUsdResolverGetCacheFootprint, py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Get the approximate number of bytes used by the process-wide resolve cache and the active
+            Ar.ResolverScopedCache.
+
+            Returns:
+                The footprint in bytes.
+        )");
+
+    m.def(
+        "get_cache_stats",
+        [](OmniUsdResolverCacheTier tier) -> py::object
+        {
+            OmniUsdResolverCacheStats stats{};
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = omniUsdResolverGetCacheStats(tier, &stats);
+            }
+            if (!found)
+            {
+                return py::none();
+            }
+
+            py::dict d;
+            d["hits"] = stats.hits;
+            d["misses"] = stats.misses;
+            d["inserts"] = stats.inserts;
+            d["removes"] = stats.removes;
+            d["evictions"] = stats.evictions;
+            d["entries"] = stats.entries;
+            d["bytes"] = stats.bytes;
+            return std::move(d);
+        },
+        py::arg("tier"),
+        R"(
+            Get the counters for a resolve cache.
+
+            Args:
+                tier (CacheTier): SCOPED for the active Ar.ResolverScopedCache or GLOBAL for the process-wide cache.
+
+            Returns:
+                A dictionary with the keys "hits", "misses", "inserts", "removes", "evictions", "entries" and "bytes".
+                None if there is no cache for the tier.
+        )");
+
+    m.def(
+        "get_hottest_cache_keys",
+        [](OmniUsdResolverCacheTier tier, size_t count)
+        {
+            std::vector<std::pair<std::string, uint64_t>> keys;
+            {
+                py::gil_scoped_release release;
+                omniUsdResolverGetHottestCacheKeys(tier, count, &keys,
+                                                   [](void* userData, const char* key, uint64_t hits) noexcept {
+                                                       static_cast<std::vector<std::pair<std::string, uint64_t>>*>(
+                                                           userData)
+                                                           ->emplace_back(key, hits);
+                                                   });
+            }
+            return keys;
+        },
+        py::arg("tier"), py::arg("count") = 10,
+        R"(
+            Get the keys in a resolve cache with the most hits.
+
+            Args:
+                tier (CacheTier): SCOPED for the active Ar.ResolverScopedCache or GLOBAL for the process-wide cache.
+                count (int): The maximum number of keys.
+
+            Returns:
+                A list of (key, hits) tuples ordered from most to least hits.
+        )");
+
+    m.def("set_search_path_cache_ttl", &omniUsdResolverSetSearchPathCacheTtl, py::arg("seconds"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+            Set how long a search path that failed to resolve next to the layer referencing it is remembered.
+
+            Args:
+                seconds (float): The time-to-live in seconds. Zero disables the search path cache.
+        )");
 }
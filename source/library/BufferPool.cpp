@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "BufferPool.h"
+
+#include <mutex>
+#include <vector>
+
+namespace
+{
+// Size classes range from 256 bytes to 1 MiB
+constexpr size_t kMinClassBits = 8;
+constexpr size_t kMaxClassBits = 20;
+constexpr size_t kClassCount = kMaxClassBits - kMinClassBits + 1;
+
+// Number of bytes kept for reuse in each size class
+constexpr size_t kMaxPooledBytes = 4 * 1024 * 1024;
+
+struct SizeClass
+{
+    std::mutex mutex;
+    std::vector<char*> free;
+};
+
+// Never destroyed, since buffers can be released after static destruction has started
+SizeClass* _GetClasses()
+{
+    static SizeClass* classes = new SizeClass[kClassCount];
+    return classes;
+}
+
+size_t _GetClassIndex(size_t size)
+{
+    size_t bits = kMinClassBits;
+    while ((size_t(1) << bits) < size)
+    {
+        ++bits;
+    }
+    return bits - kMinClassBits;
+}
+
+size_t _GetClassSize(size_t index)
+{
+    return size_t(1) << (index + kMinClassBits);
+}
+
+void _Release(size_t index, char* data)
+{
+    SizeClass& sizeClass = _GetClasses()[index];
+    {
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if ((sizeClass.free.size() + 1) * _GetClassSize(index) <= kMaxPooledBytes)
+        {
+            sizeClass.free.push_back(data);
+            return;
+        }
+    }
+    delete[] data;
+}
+} // namespace
+
+namespace buffer_pool
+{
+std::shared_ptr<char> Acquire(size_t size)
+{
+    if (size > (size_t(1) << kMaxClassBits))
+    {
+        return std::shared_ptr<char>(new char[size], std::default_delete<char[]>());
+    }
+
+    const size_t index = _GetClassIndex(size);
+    SizeClass& sizeClass = _GetClasses()[index];
+
+    char* data = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if (!sizeClass.free.empty())
+        {
+            data = sizeClass.free.back();
+            sizeClass.free.pop_back();
+        }
+    }
+    if (!data)
+    {
+        data = new char[_GetClassSize(index)];
+    }
+
+    return std::shared_ptr<char>(data, [index](char* buffer) { _Release(index, buffer); });
+}
+} // namespace buffer_pool
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+/// A pool of memory buffers for assets that are read into memory.
+///
+/// Buffers are grouped into power-of-two size classes. When the last reference to a buffer is released it is kept
+/// for reuse by the next buffer of the same class, up to a fixed number of bytes per class, rather than freed.
+namespace buffer_pool
+{
+/// \brief Returns a buffer that can hold at least \p size bytes
+/// \note Buffers larger than the largest size class are allocated and freed without going through the pool
+std::shared_ptr<char> Acquire(size_t size);
+} // namespace buffer_pool
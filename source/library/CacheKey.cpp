@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "CacheKey.h"
+
+namespace
+{
+constexpr std::string_view kOmniScheme{ "omni" };
+constexpr std::string_view kOmniverseScheme{ "omniverse" };
+constexpr std::string_view kEncodedSpace{ "%20" };
+
+struct UrlParts
+{
+    std::string_view scheme;
+    bool hasAuthority = false;
+    std::string_view userInfo; // including the trailing '@'
+    std::string_view host;
+    bool hasPort = false;
+    std::string_view port; // without the leading ':'
+    std::string_view path;
+    std::string_view rest; // query and fragment
+};
+
+inline bool _IsUpper(char c)
+{
+    return c >= 'A' && c <= 'Z';
+}
+
+inline char _ToLower(char c)
+{
+    return _IsUpper(c) ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool _IsAlpha(char c)
+{
+    return _IsUpper(c) || (c >= 'a' && c <= 'z');
+}
+
+inline bool _IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool _HasUpper(std::string_view s)
+{
+    for (char c : s)
+    {
+        if (_IsUpper(c))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool _EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (_ToLower(a[i]) != _ToLower(b[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+UrlParts _Split(std::string_view identifier)
+{
+    UrlParts parts;
+
+    // A scheme needs at least two characters so Windows drive letters, i.e C:/path, are treated as local paths
+    const size_t colon = identifier.find(':');
+    if (colon != std::string_view::npos && colon >= 2 && _IsAlpha(identifier[0]))
+    {
+        bool validScheme = true;
+        for (size_t i = 1; i < colon && validScheme; ++i)
+        {
+            const char c = identifier[i];
+            validScheme = _IsAlpha(c) || _IsDigit(c) || c == '+' || c == '-' || c == '.';
+        }
+
+        if (validScheme)
+        {
+            parts.scheme = identifier.substr(0, colon);
+            identifier.remove_prefix(colon + 1);
+        }
+    }
+
+    if (!parts.scheme.empty() && identifier.substr(0, 2) == "//")
+    {
+        identifier.remove_prefix(2);
+        parts.hasAuthority = true;
+
+        std::string_view authority = identifier.substr(0, identifier.find_first_of("/?#"));
+        identifier.remove_prefix(authority.size());
+
+        const size_t at = authority.rfind('@');
+        if (at != std::string_view::npos)
+        {
+            parts.userInfo = authority.substr(0, at + 1);
+            authority.remove_prefix(at + 1);
+        }
+
+        // The port is only split off if it comes after any IPv6 literal, i.e [::1]:80
+        const size_t portColon = authority.rfind(':');
+        if (portColon != std::string_view::npos && authority.find(']', portColon) == std::string_view::npos)
+        {
+            parts.hasPort = true;
+            parts.port = authority.substr(portColon + 1);
+            authority = authority.substr(0, portColon);
+        }
+        parts.host = authority;
+    }
+
+    const size_t restStart = identifier.find_first_of("?#");
+    parts.path = identifier.substr(0, restStart);
+    if (restStart != std::string_view::npos)
+    {
+        parts.rest = identifier.substr(restStart);
+    }
+
+    return parts;
+}
+
+bool _IsDefaultPort(std::string_view scheme, std::string_view port)
+{
+    if (port.empty())
+    {
+        // "host:" is the same as "host"
+        return true;
+    }
+
+    return (port == "80" && _EqualsIgnoreCase(scheme, "http")) || (port == "443" && _EqualsIgnoreCase(scheme, "https"));
+}
+
+bool _HasDotSegment(std::string_view path)
+{
+    // Only absolute paths have their "." segments removed. Removing the leading "./" from a relative path
+    // would turn a file-relative path into a search path
+    if (path.empty() || path[0] != '/')
+    {
+        return false;
+    }
+
+    return path.find("/./") != std::string_view::npos ||
+           (path.size() >= 2 && path.substr(path.size() - 2) == "/.");
+}
+
+void _AppendPath(std::string_view path, std::string& buffer)
+{
+    const bool removeDots = !path.empty() && path[0] == '/';
+
+    size_t start = 0;
+    while (start <= path.size())
+    {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos)
+        {
+            end = path.size();
+        }
+
+        const std::string_view segment = path.substr(start, end - start);
+        const bool last = end == path.size();
+        if (removeDots && start > 0 && segment == ".")
+        {
+            // Drop the segment but keep the trailing separator so "/a/." stays a directory
+            if (last && (buffer.empty() || buffer.back() != '/'))
+            {
+                buffer.push_back('/');
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < segment.size(); ++i)
+            {
+                if (segment.substr(i, kEncodedSpace.size()) == kEncodedSpace)
+                {
+                    buffer.push_back(' ');
+                    i += kEncodedSpace.size() - 1;
+                }
+                else
+                {
+                    buffer.push_back(segment[i]);
+                }
+            }
+
+            if (!last)
+            {
+                buffer.push_back('/');
+            }
+        }
+
+        start = end + 1;
+    }
+}
+} // namespace
+
+namespace cache_key
+{
+bool IsCanonical(std::string_view identifier)
+{
+    const UrlParts parts = _Split(identifier);
+
+    if (_HasUpper(parts.scheme) || parts.scheme == kOmniScheme)
+    {
+        return false;
+    }
+
+    if (_HasUpper(parts.host) || (parts.hasPort && _IsDefaultPort(parts.scheme, parts.port)))
+    {
+        return false;
+    }
+
+    return parts.path.find(kEncodedSpace) == std::string_view::npos && !_HasDotSegment(parts.path);
+}
+
+std::string_view Canonicalize(std::string_view identifier, std::string& buffer)
+{
+    if (IsCanonical(identifier))
+    {
+        return identifier;
+    }
+
+    const UrlParts parts = _Split(identifier);
+
+    buffer.clear();
+    buffer.reserve(identifier.size() + kOmniverseScheme.size());
+
+    if (!parts.scheme.empty())
+    {
+        if (_EqualsIgnoreCase(parts.scheme, kOmniScheme))
+        {
+            buffer.append(kOmniverseScheme);
+        }
+        else
+        {
+            for (char c : parts.scheme)
+            {
+                buffer.push_back(_ToLower(c));
+            }
+        }
+        buffer.push_back(':');
+    }
+
+    if (parts.hasAuthority)
+    {
+        buffer.append("//");
+        buffer.append(parts.userInfo);
+        for (char c : parts.host)
+        {
+            buffer.push_back(_ToLower(c));
+        }
+        if (parts.hasPort && !_IsDefaultPort(parts.scheme, parts.port))
+        {
+            buffer.push_back(':');
+            buffer.append(parts.port);
+        }
+    }
+
+    _AppendPath(parts.path, buffer);
+    buffer.append(parts.rest);
+
+    return buffer;
+}
+} // namespace cache_key
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/// Canonical keys for the resolve caches.
+///
+/// The same asset can be spelled many different ways, i.e OMNIVERSE://Server/a/./b%20c.usd, omni://server/a/b c.usd
+/// or https://server:443/a/b.usd and https://server/a/b.usd. Without canonicalization each spelling would get its own cache entry and its
+/// own request to the server. The rules applied are:
+///
+/// - The scheme and host are lower-cased and the "omni" scheme is treated as "omniverse"
+/// - Default ports for http (80) and https (443) are removed
+/// - "%20" in the path is decoded to a space
+/// - "." segments in the path are removed
+///
+/// Anything after a '?' or '#' is left as-is.
+namespace cache_key
+{
+/// \brief Returns true if \p identifier is already in canonical form
+bool IsCanonical(std::string_view identifier);
+
+/// \brief Returns the canonical form of \p identifier
+///
+/// Most identifiers are already canonical, in which case \p identifier is returned without allocating.
+/// Otherwise the canonical form is written to \p buffer and a view of \p buffer is returned.
+/// \param identifier the identifier to canonicalize
+/// \param buffer storage for the canonical form if it differs from \p identifier
+/// \returns a view of either \p identifier or \p buffer
+std::string_view Canonicalize(std::string_view identifier, std::string& buffer);
+} // namespace cache_key
@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "ContextPartition.h"
+
+#include "DebugCodes.h"
+#include "GlobalCache.h"
+#include "utils/OmniClientUtils.h"
+#include "utils/PythonUtils.h"
+#include "utils/StringUtils.h"
+
+#include <pxr/base/tf/debug.h>
+
+#include <OmniClient.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+std::atomic<uint64_t> g_generation{ 0 };
+
+struct ListContext
+{
+    OmniClientResult result;
+    std::unordered_set<std::string>& names;
+};
+
+void _ListCallback(void* userData,
+                   OmniClientResult result,
+                   uint32_t numEntries,
+                   struct OmniClientListEntry const* entries) noexcept
+{
+    auto& context = *static_cast<ListContext*>(userData);
+    context.result = result;
+    if (result != eOmniClientResult_Ok)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < numEntries; ++i)
+    {
+        context.names.emplace(safeString(entries[i].relativePath));
+    }
+}
+} // namespace
+
+ContextPartition::ContextPartition(std::vector<std::string> searchRoots)
+    : _searchRoots(std::move(searchRoots)), _generation(g_generation.load(std::memory_order_acquire))
+{
+    for (auto& root : _searchRoots)
+    {
+        if (!root.empty() && root.back() != '/')
+        {
+            root.push_back('/');
+        }
+    }
+}
+
+const std::vector<std::string>& ContextPartition::GetSearchRoots() const
+{
+    return _searchRoots;
+}
+
+std::vector<std::string> ContextPartition::FindCandidates(const std::string& assetPath)
+{
+    _SyncGeneration();
+
+    std::vector<std::string> candidates;
+    for (const auto& root : _searchRoots)
+    {
+        std::string url = makeString(omniClientCombineUrls, root.c_str(), assetPath.c_str());
+
+        const size_t slash = url.rfind('/');
+        if (slash == std::string::npos)
+        {
+            continue;
+        }
+
+        auto listing = _GetListing(url.substr(0, slash + 1));
+        if (!listing || !listing->listed)
+        {
+            // Nothing is known about this root, so it has to be probed
+            candidates.push_back(std::move(url));
+            continue;
+        }
+
+        if (listing->names.count(url.substr(slash + 1)) != 0)
+        {
+            candidates.push_back(std::move(url));
+            break;
+        }
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT)
+        .Msg("%s: %s has %zu candidates\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), candidates.size());
+    return candidates;
+}
+
+OmniUsdResolverCache& ContextPartition::GetCache()
+{
+    _SyncGeneration();
+    return _cache;
+}
+
+void ContextPartition::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _listings.clear();
+    _cache.Clear();
+}
+
+OmniUsdResolverCache::Clock::duration ContextPartition::GetTtl(const std::string& url)
+{
+    return global_cache::GetTtl(url);
+}
+
+void ContextPartition::InvalidateAll()
+{
+    g_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::shared_ptr<ContextPartition::Listing> ContextPartition::_GetListing(const std::string& dirUrl)
+{
+    // Other processes can add assets under a search root, so a listing is only trusted for as long as the global
+    // cache would trust a resolve. Without a time-to-live the roots are probed instead
+    const auto ttl = GetTtl(dirUrl);
+    if (ttl == OmniUsdResolverCache::Clock::duration::zero())
+    {
+        return nullptr;
+    }
+
+    const auto now = OmniUsdResolverCache::Clock::now();
+    std::shared_ptr<Listing> listing;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& slot = _listings[dirUrl];
+        if (!slot || slot->expires <= now)
+        {
+            slot = std::make_shared<Listing>();
+            slot->expires = now + ttl;
+        }
+        listing = slot;
+    }
+
+    // Other threads that need the same directory wait for the first one to list it
+    PyReleaseGil releaseGil;
+    std::call_once(
+        listing->once,
+        [&]()
+        {
+            ListContext context{ eOmniClientResult_Error, listing->names };
+            omniClientWait(omniClientList(dirUrl.c_str(), &context, _ListCallback));
+
+            // A directory that does not exist is known to be empty
+            listing->listed = context.result == eOmniClientResult_Ok || context.result == eOmniClientResult_ErrorNotFound;
+            TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT)
+                .Msg("%s: listed %zu entries in %s\n", TF_FUNC_NAME().c_str(), listing->names.size(), dirUrl.c_str());
+        });
+
+    return listing;
+}
+
+void ContextPartition::_SyncGeneration()
+{
+    const uint64_t generation = g_generation.load(std::memory_order_acquire);
+    if (_generation.load(std::memory_order_acquire) == generation)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_generation.exchange(generation, std::memory_order_acq_rel) != generation)
+    {
+        _listings.clear();
+        _cache.Clear();
+    }
+}
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdResolverCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// \brief The part of the resolver state that belongs to a single OmniUsdResolverContext with search paths
+///
+/// Search paths resolve differently depending on the search roots of the bound context, so they are cached
+/// in a partition owned by the context rather than in the global cache. A partition also lists the directories
+/// under its search roots. After that, finding which root holds a search path is a lookup in memory instead of
+/// one remote probe per root. Listings are made lazily, the first time a directory is needed, and are trusted for the
+/// time-to-live the global cache uses for the scheme of the directory. Without a time-to-live every root is probed.
+class ContextPartition
+{
+public:
+    /// \param searchRoots the directories to look in, in order. A trailing '/' is added where missing
+    explicit ContextPartition(std::vector<std::string> searchRoots);
+
+    /// \brief Returns the search roots, in the order they are searched
+    const std::vector<std::string>& GetSearchRoots() const;
+
+    /// \brief Finds the URLs that \p assetPath could resolve to under the search roots
+    ///
+    /// Roots whose listing shows \p assetPath is not there are skipped. Search stops at the first root whose
+    /// listing contains \p assetPath. Roots that could not be listed are kept as candidates, so the caller
+    /// still probes them.
+    /// \returns the candidate URLs in search order. Empty if no search root can contain \p assetPath
+    std::vector<std::string> FindCandidates(const std::string& assetPath);
+
+    /// \brief Returns the resolve cache for search paths resolved in this partition
+    /// \note Entries should be added with the time-to-live of GetTtl so they expire together with the listings
+    OmniUsdResolverCache& GetCache();
+
+    /// \brief Returns how long a listing of, or a resolve in, \p url is trusted. Zero if it should not be cached
+    static OmniUsdResolverCache::Clock::duration GetTtl(const std::string& url);
+
+    /// \brief Forgets all cached resolves and directory listings of this partition
+    void Clear();
+
+    /// \brief Invalidates the caches and listings of every partition, i.e when an asset has been written
+    static void InvalidateAll();
+
+private:
+    struct Listing
+    {
+        std::once_flag once;
+        bool listed = false;
+        OmniUsdResolverCache::Clock::time_point expires;
+        std::unordered_set<std::string> names;
+    };
+
+    std::shared_ptr<Listing> _GetListing(const std::string& dirUrl);
+    void _SyncGeneration();
+
+    std::vector<std::string> _searchRoots;
+
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<Listing>> _listings;
+    std::atomic<uint64_t> _generation;
+
+    OmniUsdResolverCache _cache;
+};
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "ContextStack.h"
+
+#include "utils/OmniClientUtils.h"
+
+#include <vector>
+
+namespace
+{
+thread_local std::vector<OmniUsdResolverContext> t_contexts;
+} // namespace
+
+namespace context_stack
+{
+void Push(OmniUsdResolverContext context)
+{
+    t_contexts.push_back(std::move(context));
+}
+
+bool Pop(const OmniUsdResolverContext& context)
+{
+    if (t_contexts.empty() || !(t_contexts.back() == context))
+    {
+        return false;
+    }
+
+    t_contexts.pop_back();
+    return true;
+}
+
+const OmniUsdResolverContext* GetContext()
+{
+    return t_contexts.empty() ? nullptr : &t_contexts.back();
+}
+
+const std::string* GetAnchor()
+{
+    return t_contexts.empty() || t_contexts.back().GetAssetPath().empty() ? nullptr : &t_contexts.back().GetAssetPath();
+}
+
+std::string CombineWithAnchor(const std::string& url)
+{
+    if (const std::string* anchor = GetAnchor())
+    {
+        return makeString(omniClientCombineUrls, anchor->c_str(), url.c_str());
+    }
+
+    return makeString(omniClientCombineWithBaseUrl, url.c_str());
+}
+} // namespace context_stack
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdResolverContext_Ar2.h"
+
+#include <string>
+
+/// The resolver contexts bound on the calling thread.
+///
+/// Binding an OmniUsdResolverContext used to push its asset path onto client-library's base URL stack, which is
+/// shared by every thread in the process. Instead, each thread keeps its own stack here and the bound asset path
+/// is passed to client-library explicitly when resolving. This mirrors how ArDefaultResolver tracks its contexts.
+/// When no context with an asset path is bound the base URL of client-library still applies, so applications that
+/// call omniClientPushBaseUrl themselves keep working.
+namespace context_stack
+{
+/// \brief Pushes a context being bound on the calling thread
+/// \param context the context. A context with an empty asset path means no anchor is bound
+void Push(OmniUsdResolverContext context);
+
+/// \brief Pops a context being unbound on the calling thread
+/// \returns false if \p context was not the innermost context bound on the calling thread
+bool Pop(const OmniUsdResolverContext& context);
+
+/// \brief Returns the innermost context bound on the calling thread
+/// \returns nullptr if no context is bound. The pointer is valid until the next call to Push or Pop on the
+/// calling thread
+const OmniUsdResolverContext* GetContext();
+
+/// \brief Returns the asset path of the innermost context bound on the calling thread
+/// \returns nullptr if no context is bound or the innermost context does not have an asset path. The pointer is
+/// valid until the next call to Push or Pop on the calling thread
+const std::string* GetAnchor();
+
+/// \brief Combines \p url with the anchor bound on the calling thread
+/// \note Without a bound anchor this falls back to the base URL of client-library, i.e omniClientCombineWithBaseUrl
+std::string CombineWithAnchor(const std::string& url);
+} // namespace context_stack
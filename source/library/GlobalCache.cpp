@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "GlobalCache.h"
+
+#include "ContextPartition.h"
+#include "DebugCodes.h"
+#include "OmniUsdPackage.h"
+#include "OmniUsdResolver.h"
+#include "Prefetch.h"
+#include "ResolveIndex.h"
+#include "SearchPathCache.h"
+#include "utils/StringUtils.h"
+
+#include <pxr/base/tf/debug.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/stringUtils.h>
+
+#include <atomic>
+#include <map>
+#include <shared_mutex>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_GLOBAL_CACHE,
+                      false,
+                      "Enables the process-wide resolve cache used outside of an ArResolverScopedCache");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_GLOBAL_CACHE_TTL,
+                      "*=30,file=5",
+                      "Comma-separated list of scheme=seconds for how long a resolve is kept in the global cache. "
+                      "'*' applies to any scheme not listed and local paths use the 'file' scheme");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+using Clock = OmniUsdResolverCache::Clock;
+
+static const std::string kAnyScheme{ "*" };
+static const std::string kFileScheme{ "file" };
+
+std::atomic<bool> g_enabled{ TfGetEnvSetting(OMNI_USD_RESOLVER_GLOBAL_CACHE) };
+OmniUsdResolverCache g_cache;
+
+std::shared_mutex g_ttlMutex;
+std::map<std::string, Clock::duration> g_ttls;
+
+Clock::duration _SecondsToDuration(double seconds)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.0)));
+}
+
+struct PopulateTtlsFromEnv
+{
+    PopulateTtlsFromEnv()
+    {
+        for (const auto& schemeTtl : TfStringSplit(TfGetEnvSetting(OMNI_USD_RESOLVER_GLOBAL_CACHE_TTL), ","))
+        {
+            const auto pair = TfStringSplit(schemeTtl, "=");
+            if (pair.size() != 2)
+            {
+                TF_WARN("Ignoring invalid OMNI_USD_RESOLVER_GLOBAL_CACHE_TTL entry '%s'", schemeTtl.c_str());
+                continue;
+            }
+
+            std::string scheme = TfStringTrim(pair[0]);
+            str_tolower(scheme);
+            g_ttls[scheme] = _SecondsToDuration(TfStringToDouble(TfStringTrim(pair[1])));
+        }
+    }
+};
+static PopulateTtlsFromEnv g_populateTtlsFromEnv;
+
+std::string _GetScheme(std::string_view key)
+{
+    // A scheme needs at least two characters so Windows drive letters, i.e C:/path, are treated as local paths
+    const auto colon = key.find(':');
+    if (colon == std::string_view::npos || colon < 2 || colon > key.find('/'))
+    {
+        return kFileScheme;
+    }
+
+    std::string scheme(key.substr(0, colon));
+    str_tolower(scheme);
+    return scheme;
+}
+
+Clock::duration _GetTtl(std::string_view key)
+{
+    const std::string scheme = _GetScheme(key);
+
+    std::shared_lock<std::shared_mutex> lock(g_ttlMutex);
+
+    auto it = g_ttls.find(scheme);
+    if (it == g_ttls.end())
+    {
+        it = g_ttls.find(kAnyScheme);
+    }
+
+    return it != g_ttls.end() ? it->second : Clock::duration::zero();
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetGlobalCacheEnabled(bool enabled) OMNIUSDRESOLVER_NOEXCEPT
+{
+    if (!g_enabled.exchange(enabled))
+    {
+        // Anything left over from when the cache was last enabled is stale
+        g_cache.Clear();
+    }
+}
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetGlobalCacheTtl(const char* scheme, double seconds) OMNIUSDRESOLVER_NOEXCEPT
+{
+    std::string key = scheme ? std::string(scheme) : kAnyScheme;
+    str_tolower(key);
+
+    std::unique_lock<std::shared_mutex> lock(g_ttlMutex);
+    g_ttls[key] = _SecondsToDuration(seconds);
+}
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverFlushCache() OMNIUSDRESOLVER_NOEXCEPT
+{
+    TF_DEBUG(OMNI_USD_RESOLVER).Msg("%s: flushing global cache\n", TF_FUNC_NAME().c_str());
+    global_cache::Clear();
+    search_path_cache::Clear();
+    resolve_index::Clear();
+    ContextPartition::InvalidateAll();
+    prefetch::Clear();
+    OmniUsdPackage::Clear();
+}
+
+namespace global_cache
+{
+bool IsEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+OmniUsdResolverCache::EntryPtr Get(std::string_view key)
+{
+    return IsEnabled() ? g_cache.Get(key) : nullptr;
+}
+
+void Add(std::string_view key, const OmniUsdResolverCache::EntryPtr& entry)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    // A zero time-to-live disables the global cache for that scheme
+    const Clock::duration ttl = _GetTtl(key);
+    if (ttl != Clock::duration::zero())
+    {
+        g_cache.Add(key, entry, ttl);
+    }
+}
+
+OmniUsdResolverCache::Clock::duration GetTtl(std::string_view key)
+{
+    return _GetTtl(key);
+}
+
+bool Remove(std::string_view key)
+{
+    return g_cache.Remove(key);
+}
+
+bool GetIdentifier(std::string_view anchor, std::string_view assetPath, std::string& identifier)
+{
+    return IsEnabled() && g_cache.GetIdentifier(anchor, assetPath, identifier);
+}
+
+void AddIdentifier(std::string_view anchor, std::string_view assetPath, const std::string& identifier)
+{
+    if (IsEnabled())
+    {
+        g_cache.AddIdentifier(anchor, assetPath, identifier, false);
+    }
+}
+
+void Clear()
+{
+    g_cache.Clear();
+}
+
+size_t GetFootprint()
+{
+    return g_cache.GetFootprint();
+}
+
+const OmniUsdResolverCache& GetCache()
+{
+    return g_cache;
+}
+} // namespace global_cache
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdResolverCache.h"
+
+#include <string_view>
+
+/// The process-wide resolve cache that sits behind the scoped OmniUsdResolverCache.
+///
+/// Unlike the scoped cache, which only lives as long as an ArResolverScopedCache, entries in the
+/// global cache expire after a configurable time-to-live per URL scheme. The global cache is opt-in
+/// and can be enabled with OMNI_USD_RESOLVER_GLOBAL_CACHE or omniUsdResolverSetGlobalCacheEnabled.
+namespace global_cache
+{
+/// \brief Returns true if the global cache is enabled
+bool IsEnabled();
+
+/// \brief Finds the entry in the global cache located at \p key
+/// \param key the key to the entry in the cache
+/// \returns the entry if the global cache is enabled and an unexpired entry was found. Otherwise, nullptr
+OmniUsdResolverCache::EntryPtr Get(std::string_view key);
+
+/// \brief Adds an entry to the global cache using the time-to-live configured for the scheme of \p key
+/// \note Nothing is added if the global cache is disabled or the time-to-live for the scheme is zero
+/// \param key the key to the entry that is being cached
+/// \param entry the data entry that will be added to the cache
+void Add(std::string_view key, const OmniUsdResolverCache::EntryPtr& entry);
+
+/// \brief Returns the time-to-live configured for the scheme of \p key, whether or not the global cache is enabled
+OmniUsdResolverCache::Clock::duration GetTtl(std::string_view key);
+
+/// \brief Removes the entry in the global cache located at \p key
+/// \returns true if the entry was removed. Otherwise, false
+bool Remove(std::string_view key);
+
+/// \brief Finds the identifier memoized for \p assetPath anchored to \p anchor
+/// \returns true if the global cache is enabled and a memoized identifier was found. Otherwise, false
+bool GetIdentifier(std::string_view anchor, std::string_view assetPath, std::string& identifier);
+
+/// \brief Memoizes the identifier created for \p assetPath anchored to \p anchor
+/// \note Identifiers do not expire, so only identifiers that did not depend on what exists next to the anchor
+/// should be added here
+void AddIdentifier(std::string_view anchor, std::string_view assetPath, const std::string& identifier);
+
+/// \brief Invalidates all entries and memoized identifiers in the global cache
+void Clear();
+
+/// \brief Returns the approximate number of bytes used by the global cache
+size_t GetFootprint();
+
+/// \brief Returns the cache backing the global cache, i.e for statistics
+const OmniUsdResolverCache& GetCache();
+} // namespace global_cache
@@ -0,0 +1,392 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "IoBackend.h"
+
+#include "DebugCodes.h"
+#include "OmniUsdResolver.h"
+
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/envSetting.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+#    if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#        define OMNIUSDRESOLVER_IO_URING 1
+#    endif
+#endif
+#ifndef OMNIUSDRESOLVER_IO_URING
+#    define OMNIUSDRESOLVER_IO_URING 0
+#endif
+
+#include <atomic>
+
+#if OMNIUSDRESOLVER_IO_URING
+#    include <algorithm>
+#    include <cerrno>
+#    include <condition_variable>
+#    include <cstring>
+#    include <mutex>
+#    include <thread>
+#    include <vector>
+#endif
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_IO_URING,
+                      false,
+                      "Read local files with io_uring on Linux. Reads fall back to pread if io_uring is not available");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_IO_URING_ENTRIES,
+                      256,
+                      "Number of submission queue entries of the io_uring used to read local files");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+std::atomic<bool> g_ioUringEnabled{ TfGetEnvSetting(OMNI_USD_RESOLVER_IO_URING) };
+
+void _PRead(FILE* file, io_backend::ReadRange& range)
+{
+    range.numRead = ArchPRead(file, range.out, range.count, static_cast<int64_t>(range.offset));
+}
+
+#if OMNIUSDRESOLVER_IO_URING
+// The ranges of a single call to io_backend::Read
+struct Batch
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = 0;
+};
+
+struct Request
+{
+    io_backend::ReadRange* range = nullptr;
+    Batch* batch = nullptr;
+    iovec iov = {};
+};
+
+int _Enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+/// An io_uring shared by every thread. It is created on first use and never destroyed, since the completion thread
+/// runs for the life of the process
+class Ring
+{
+public:
+    /// Returns nullptr if io_uring is not available
+    static Ring* Create(unsigned entries)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        const int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                .Msg("%s: io_uring is not available (%s)\n", TF_FUNC_NAME().c_str(), ArchStrerror(errno).c_str());
+            return nullptr;
+        }
+
+        size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap)
+        {
+            sqSize = cqSize = std::max(sqSize, cqSize);
+        }
+
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_SHARED | MAP_POPULATE;
+        char* sq = static_cast<char*>(mmap(nullptr, sqSize, prot, flags, fd, IORING_OFF_SQ_RING));
+        char* cq = singleMap || sq == MAP_FAILED ?
+                       sq :
+                       static_cast<char*>(mmap(nullptr, cqSize, prot, flags, fd, IORING_OFF_CQ_RING));
+        void* sqes = cq == MAP_FAILED ?
+                         MAP_FAILED :
+                         mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), prot, flags, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                .Msg("%s: unable to map the io_uring (%s)\n", TF_FUNC_NAME().c_str(), ArchStrerror(errno).c_str());
+            if (cq != MAP_FAILED && cq != sq)
+            {
+                munmap(cq, cqSize);
+            }
+            if (sq != MAP_FAILED)
+            {
+                munmap(sq, sqSize);
+            }
+            close(fd);
+            return nullptr;
+        }
+
+        Ring* ring = new Ring();
+        ring->_fd = fd;
+        ring->_sqEntries = params.sq_entries;
+        ring->_cqEntries = params.cq_entries;
+        ring->_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        ring->_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->_sqes = static_cast<io_uring_sqe*>(sqes);
+        ring->_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        std::thread(&Ring::_Reap, ring).detach();
+
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: reading local files with io_uring (%u entries)\n", TF_FUNC_NAME().c_str(), params.sq_entries);
+        return ring;
+    }
+
+    /// Returns false once submitting to the ring has failed, after which every read is issued with pread
+    bool IsUsable() const
+    {
+        return !_failed.load(std::memory_order_relaxed);
+    }
+
+    /// Ranges that could not be read are left with a numRead of -1, so they can be read with pread instead
+    void Read(int fd, io_backend::ReadRange* ranges, size_t count)
+    {
+        std::vector<Request> requests(count);
+        Batch batch;
+        batch.remaining = count;
+
+        size_t submitted = 0;
+        bool failed = false;
+        while (submitted < count && !failed)
+        {
+            std::unique_lock<std::mutex> lock(_submitMutex);
+
+            // Keep the requests in flight within the completion queue so no completion is dropped
+            _capacity.wait(lock, [this] { return _inFlight < _cqEntries; });
+
+            const unsigned tail = *_sqTail;
+            const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+            const unsigned numQueued = static_cast<unsigned>(
+                std::min({ count - submitted, size_t(_sqEntries - (tail - head)), size_t(_cqEntries - _inFlight) }));
+            for (unsigned i = 0; i < numQueued; ++i)
+            {
+                Request& request = requests[submitted + i];
+                request.range = &ranges[submitted + i];
+                request.batch = &batch;
+                request.iov.iov_base = request.range->out;
+                request.iov.iov_len = request.range->count;
+
+                const unsigned index = (tail + i) & _sqMask;
+                io_uring_sqe& sqe = _sqes[index];
+                memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_READV;
+                sqe.fd = fd;
+                sqe.off = request.range->offset;
+                sqe.addr = reinterpret_cast<uint64_t>(&request.iov);
+                sqe.len = 1;
+                sqe.user_data = reinterpret_cast<uint64_t>(&request);
+                _sqArray[index] = index;
+            }
+            __atomic_store_n(_sqTail, tail + numQueued, __ATOMIC_RELEASE);
+            _inFlight += numQueued;
+
+            // Every range queued above is submitted with a single system call
+            unsigned toSubmit = numQueued;
+            while (toSubmit > 0)
+            {
+                const int numSubmitted = _Enter(_fd, toSubmit, 0, 0);
+                if (numSubmitted >= 0)
+                {
+                    toSubmit -= static_cast<unsigned>(numSubmitted);
+                    continue;
+                }
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                {
+                    continue;
+                }
+
+                TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                    .Msg("%s: unable to submit reads to io_uring (%s). Reading with pread instead\n",
+                         TF_FUNC_NAME().c_str(), ArchStrerror(errno).c_str());
+
+                // A failed io_uring_enter consumes no entries, and nothing else submits while the mutex is held, so
+                // the entries that were not submitted are taken back before they can point into a returned frame
+                __atomic_store_n(_sqTail, tail + numQueued - toSubmit, __ATOMIC_RELEASE);
+                _inFlight -= toSubmit;
+                _failed.store(true, std::memory_order_relaxed);
+                failed = true;
+                break;
+            }
+            submitted += numQueued - toSubmit;
+        }
+
+        if (failed)
+        {
+            _capacity.notify_all();
+            for (size_t i = submitted; i < count; ++i)
+            {
+                ranges[i].numRead = -1;
+            }
+
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            batch.remaining -= count - submitted;
+        }
+
+        // Ranges that were submitted point into this frame, so their completions are waited on even after a failure
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done.wait(lock, [&batch] { return batch.remaining == 0; });
+    }
+
+private:
+    Ring() = default;
+
+    // Reaps completions for every thread
+    void _Reap()
+    {
+        while (true)
+        {
+            if (_Enter(_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN &&
+                errno != EBUSY)
+            {
+                TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                    .Msg("%s: waiting on io_uring failed (%s)\n", TF_FUNC_NAME().c_str(), ArchStrerror(errno).c_str());
+            }
+
+            unsigned head = *_cqHead;
+            const unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+            const unsigned numReaped = tail - head;
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe& cqe = _cqes[head & _cqMask];
+                Request* request = reinterpret_cast<Request*>(cqe.user_data);
+
+                // A negative result is the error of the read, which is retried with pread
+                request->range->numRead = cqe.res < 0 ? -1 : cqe.res;
+
+                Batch* batch = request->batch;
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                if (--batch->remaining == 0)
+                {
+                    batch->done.notify_one();
+                }
+            }
+            __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+            if (numReaped > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_submitMutex);
+                    _inFlight -= numReaped;
+                }
+                _capacity.notify_all();
+            }
+        }
+    }
+
+    int _fd = -1;
+    unsigned _sqEntries = 0;
+    unsigned _cqEntries = 0;
+
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned* _sqArray = nullptr;
+    io_uring_sqe* _sqes = nullptr;
+
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    std::mutex _submitMutex;
+    std::condition_variable _capacity;
+    unsigned _inFlight = 0;
+    std::atomic<bool> _failed{ false };
+};
+
+Ring* _GetRing()
+{
+    if (!g_ioUringEnabled.load(std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    // The ring is only created the first time io_uring is enabled, and then kept for the life of the process
+    static Ring* ring =
+        Ring::Create(static_cast<unsigned>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_IO_URING_ENTRIES), 1)));
+    return ring && ring->IsUsable() ? ring : nullptr;
+}
+#endif
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetIoUringEnabled(bool enabled) OMNIUSDRESOLVER_NOEXCEPT
+{
+    g_ioUringEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+namespace io_backend
+{
+bool IsUsingIoUring()
+{
+#if OMNIUSDRESOLVER_IO_URING
+    return _GetRing() != nullptr;
+#else
+    return false;
+#endif
+}
+
+void Read(FILE* file, ReadRange* ranges, size_t count)
+{
+#if OMNIUSDRESOLVER_IO_URING
+    // A single range costs a submission, a wake up of the completion thread and a wake up of the caller, which is
+    // several times slower than a pread. io_uring only pays off when several ranges are read at once
+    Ring* ring = count > 1 ? _GetRing() : nullptr;
+    if (ring)
+    {
+        ring->Read(ArchFileNo(file), ranges, count);
+
+        // Finish short reads, and retry failed reads, with pread
+        for (size_t i = 0; i < count; ++i)
+        {
+            ReadRange& range = ranges[i];
+            if (range.numRead < 0)
+            {
+                _PRead(file, range);
+            }
+            else if (range.numRead > 0 && static_cast<size_t>(range.numRead) < range.count)
+            {
+                ReadRange rest;
+                rest.out = static_cast<char*>(range.out) + range.numRead;
+                rest.count = range.count - range.numRead;
+                rest.offset = range.offset + range.numRead;
+                _PRead(file, rest);
+                if (rest.numRead > 0)
+                {
+                    range.numRead += rest.numRead;
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        _PRead(file, ranges[i]);
+    }
+}
+} // namespace io_backend
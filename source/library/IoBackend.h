@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/// Positional reads of local files.
+///
+/// Reads are issued with ArchPRead unless the io_uring backend has been enabled with OMNI_USD_RESOLVER_IO_URING or
+/// omniUsdResolverSetIoUringEnabled. The io_uring backend shares a single ring between every thread, submits all
+/// ranges of a call with one system call and reaps completions for every thread on a single background thread. A call
+/// with a single range is always issued with ArchPRead, which is cheaper. If io_uring is not available, i.e the kernel
+/// does not support it or submitting to the ring failed, reads fall back to ArchPRead.
+namespace io_backend
+{
+struct ReadRange
+{
+    /// Where to write the data that was read
+    void* out = nullptr;
+
+    /// The number of bytes to read
+    size_t count = 0;
+
+    /// The offset in the file to read from
+    size_t offset = 0;
+
+    /// Set to the number of bytes read, which is only less than count at the end of the file, or -1 on failure
+    int64_t numRead = 0;
+};
+
+/// \brief Returns true if reads of several ranges are issued with io_uring
+bool IsUsingIoUring();
+
+/// \brief Reads every range in \p ranges from \p file
+/// \note All ranges are submitted before waiting on any of them. The result of each range is written to its numRead
+void Read(FILE* file, ReadRange* ranges, size_t count);
+} // namespace io_backend
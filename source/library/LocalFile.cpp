@@ -0,0 +1,278 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "LocalFile.h"
+
+#include "DebugCodes.h"
+#include "utils/OmniClientUtils.h"
+#include "utils/PathUtils.h"
+
+#include <pxr/base/arch/fileSystem.h>
+
+#include <OmniClient.h>
+
+#include <cstring>
+#include <unordered_map>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#endif
+
+#ifdef __linux__
+#    include <linux/fs.h>
+#    include <sys/ioctl.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+std::mutex g_filesMutex;
+std::unordered_map<std::string, std::weak_ptr<local_file::SharedFile>> g_files;
+
+// Crate files are read by seeking to the table of contents and then to the sections that are needed, while text
+// files, and most other assets, are read from start to end
+bool _IsRandomAccess(FILE* file, std::string_view url)
+{
+    const std::string_view extension = getExtension(url);
+    if (extension == "usdc")
+    {
+        return true;
+    }
+    if (extension != "usd")
+    {
+        return false;
+    }
+
+    static constexpr char kCrateMagic[] = "PXR-USDC";
+    char header[sizeof(kCrateMagic) - 1];
+    return ArchPRead(file, header, sizeof(header), 0) == sizeof(header) &&
+           memcmp(header, kCrateMagic, sizeof(header)) == 0;
+}
+
+void _AdviseFile(FILE* file, bool randomAccess)
+{
+#ifdef __linux__
+    // ArchFileAdvise has no sequential advice, so posix_fadvise is used directly
+    posix_fadvise(ArchFileNo(file), 0, 0, randomAccess ? POSIX_FADV_RANDOM : POSIX_FADV_SEQUENTIAL);
+#else
+    if (randomAccess)
+    {
+        ArchFileAdvise(file, 0, 0, ArchFileAdviceRandomAccess);
+    }
+#endif
+}
+
+void _AdviseMapping(const char* buffer, size_t length, bool randomAccess)
+{
+#ifdef _WIN32
+    if (randomAccess)
+    {
+        ArchMemAdvise(buffer, length, ArchMemAdviceRandomAccess);
+    }
+#else
+    // ArchMemAdvise has no sequential advice, so posix_madvise is used directly
+    posix_madvise(const_cast<char*>(buffer), length, randomAccess ? POSIX_MADV_RANDOM : POSIX_MADV_SEQUENTIAL);
+#endif
+}
+
+#ifdef __linux__
+// Copies size bytes from sourceFd to destinationFd, sharing the blocks of the source when the filesystem can
+bool _CloneFile(int sourceFd, int destinationFd, int64_t size)
+{
+#    ifdef FICLONE
+    if (ioctl(destinationFd, FICLONE, sourceFd) == 0)
+    {
+        return true;
+    }
+#    endif
+
+#    ifdef __NR_copy_file_range
+    // glibc only has a wrapper for copy_file_range since 2.27
+    int64_t remaining = size;
+    while (remaining > 0)
+    {
+        const long numCopied = syscall(__NR_copy_file_range, sourceFd, nullptr, destinationFd, nullptr,
+                                       static_cast<size_t>(remaining), 0u);
+        if (numCopied <= 0)
+        {
+            return false;
+        }
+        remaining -= numCopied;
+    }
+    return true;
+#    else
+    return size == 0;
+#    endif
+}
+
+void _OnLocalFile(void* userData, OmniClientResult result, char const* localFilePath) noexcept
+{
+    if (result == eOmniClientResult_Ok)
+    {
+        *static_cast<std::string*>(userData) = localFilePath;
+    }
+}
+#endif
+} // namespace
+
+namespace local_file
+{
+SharedFile::SharedFile(std::string path, FILE* file, int64_t size, double modificationTime, bool randomAccess)
+    : _path(std::move(path)), _file(file), _size(size), _modificationTime(modificationTime), _randomAccess(randomAccess)
+{
+}
+
+SharedFile::~SharedFile()
+{
+    fclose(_file);
+
+    // Forget the file unless it has already been replaced by a newer SharedFile
+    std::lock_guard<std::mutex> lock(g_filesMutex);
+    auto it = g_files.find(_path);
+    if (it != g_files.end() && it->second.expired())
+    {
+        g_files.erase(it);
+    }
+}
+
+std::shared_ptr<const char> SharedFile::GetBuffer() const
+{
+    std::lock_guard<std::mutex> lock(_mappingMutex);
+    if (!_mapping)
+    {
+        ArchConstFileMapping mapping = ArchMapFileReadOnly(_file);
+        if (!mapping)
+        {
+            return nullptr;
+        }
+
+        _AdviseMapping(mapping.get(), ArchGetFileMappingLength(mapping), _randomAccess);
+        _mapping = std::make_shared<ArchConstFileMapping>(std::move(mapping));
+    }
+
+    // The buffer shares ownership of the mapping, so it stays valid after this SharedFile is gone
+    return std::shared_ptr<const char>(_mapping, _mapping->get());
+}
+
+SharedFilePtr Open(const std::string& path, std::string_view url)
+{
+    double modificationTime = 0.0;
+    if (!ArchGetModificationTime(path.c_str(), &modificationTime))
+    {
+        return nullptr;
+    }
+    const int64_t size = ArchGetFileLength(path.c_str());
+
+    // A SharedFile that is replaced here must not be destroyed while g_filesMutex is held
+    SharedFilePtr previous;
+    {
+        std::lock_guard<std::mutex> lock(g_filesMutex);
+        auto it = g_files.find(path);
+        if (it != g_files.end())
+        {
+            previous = it->second.lock();
+            if (previous && previous->GetModificationTime() == modificationTime && previous->GetSize() == size)
+            {
+                return previous;
+            }
+        }
+    }
+
+    FILE* file = ArchOpenFile(path.c_str(), "rb");
+    if (!file)
+    {
+        return nullptr;
+    }
+
+    const bool randomAccess = _IsRandomAccess(file, url);
+    _AdviseFile(file, randomAccess);
+    auto sharedFile = std::make_shared<SharedFile>(path, file, size, modificationTime, randomAccess);
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: opened %s for %s access\n", TF_FUNC_NAME().c_str(), path.c_str(),
+             randomAccess ? "random" : "sequential");
+
+    SharedFilePtr current;
+    {
+        std::lock_guard<std::mutex> lock(g_filesMutex);
+        auto& entry = g_files[path];
+        current = entry.lock();
+        if (!current || current == previous)
+        {
+            entry = sharedFile;
+            return sharedFile;
+        }
+    }
+
+    // Another thread opened the same file first. The file opened here is closed once g_filesMutex is released
+    return current;
+}
+
+bool Clone(std::string_view url, const std::string& destination)
+{
+#ifdef __linux__
+    const std::string urlString(url);
+
+    // Without downloading the client library only returns where the file would be cached, which does not exist if it
+    // is not. Downloading a file only to clone it is slower than copying it on the server
+    std::string localFile;
+    OmniClientRequestId requestId = omniClientGetLocalFile(urlString.c_str(), false, &localFile, &_OnLocalFile);
+    omniClientWait(requestId);
+    omniClientStop(requestId);
+
+    struct stat cachedStat;
+    if (localFile.empty() || stat(fixLocalPath(localFile).c_str(), &cachedStat) != 0)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s is not cached\n", TF_FUNC_NAME().c_str(), urlString.c_str());
+        return false;
+    }
+
+    // The file is cached, so this only makes sure it is up to date. The request keeps the local file in the cache until
+    // it is stopped
+    localFile.clear();
+    requestId = omniClientGetLocalFile(urlString.c_str(), true, &localFile, &_OnLocalFile);
+    omniClientWait(requestId);
+
+    bool cloned = false;
+    const int sourceFd = localFile.empty() ? -1 : open(fixLocalPath(localFile).c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat sourceStat;
+    if (sourceFd >= 0 && fstat(sourceFd, &sourceStat) == 0)
+    {
+        const int destinationFd = open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (destinationFd >= 0)
+        {
+            cloned = _CloneFile(sourceFd, destinationFd, sourceStat.st_size);
+            close(destinationFd);
+            if (!cloned)
+            {
+                unlink(destination.c_str());
+            }
+        }
+    }
+    if (sourceFd >= 0)
+    {
+        close(sourceFd);
+    }
+    omniClientStop(requestId);
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: %s -> %s: %s\n", TF_FUNC_NAME().c_str(), localFile.c_str(), destination.c_str(),
+             cloned ? "cloned" : "failed");
+    return cloned;
+#else
+    return false;
+#endif
+}
+} // namespace local_file
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "UsdIncludes.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/// Local files shared by every asset that reads them.
+///
+/// Many layers can reference the same texture or payload, and every OmniUsdAsset for it reads the same file from the
+/// client library's local cache. Instead of opening and memory-mapping that file once per asset, and once per
+/// GetBuffer call, the file is opened once and mapped at most once for as long as any asset or buffer uses it.
+namespace local_file
+{
+class SharedFile
+{
+public:
+    SharedFile(std::string path, FILE* file, int64_t size, double modificationTime, bool randomAccess);
+    ~SharedFile();
+
+    SharedFile(const SharedFile&) = delete;
+    SharedFile& operator=(const SharedFile&) = delete;
+
+    /// Returns the path to the local file
+    const std::string& GetPath() const
+    {
+        return _path;
+    }
+
+    /// Returns the handle to the local file, which is only valid as long as this SharedFile
+    FILE* GetFile() const
+    {
+        return _file;
+    }
+
+    /// Returns the size of the local file when it was opened
+    int64_t GetSize() const
+    {
+        return _size;
+    }
+
+    /// Returns the time the local file was modified when it was opened
+    double GetModificationTime() const
+    {
+        return _modificationTime;
+    }
+
+    /// Returns whether the local file was advised for random access, i.e it is a crate file
+    bool IsRandomAccess() const
+    {
+        return _randomAccess;
+    }
+
+    /// Returns a buffer backed by the read-only memory mapping of the local file. The mapping is created by the first
+    /// call and shared with every later call. Returns nullptr if the file could not be mapped
+    std::shared_ptr<const char> GetBuffer() const;
+
+private:
+    const std::string _path;
+    FILE* const _file;
+    const int64_t _size;
+    const double _modificationTime;
+    const bool _randomAccess;
+
+    mutable std::mutex _mappingMutex;
+    mutable std::shared_ptr<ArchConstFileMapping> _mapping;
+};
+
+using SharedFilePtr = std::shared_ptr<SharedFile>;
+
+/// \brief Opens the local file at \p path for reading, sharing it with every other asset that has it open
+/// \note A file that has been modified since it was opened is opened again. Assets that still use the previous
+/// SharedFile keep reading what was there before
+/// \param path the path to the local file
+/// \param url the URL the local file was downloaded from. Its extension decides how the file and its mapping are
+/// expected to be accessed, randomly for crate files and sequentially for everything else
+/// \returns the shared file, or nullptr if the file could not be opened
+SharedFilePtr Open(const std::string& path, std::string_view url);
+
+/// \brief Copies the local file cached for \p url to a new file at \p destination without copying its content
+/// \note On Linux the copy is a reflink (FICLONE) when the cache and \p destination are on a filesystem that supports
+/// them, which makes it O(1) regardless of the size of the file. Otherwise copy_file_range lets the filesystem share
+/// blocks, or at least copy them without going through user space. The copy is never a hard link since \p destination
+/// is written to in place, which would change the cached file
+/// \note Only files that are already in the local cache are cloned. A file that is not cached would have to be downloaded
+/// first, which is slower than copying it on the server
+/// \returns false if the file is not cached or could not be copied this way, in which case \p destination does not exist
+bool Clone(std::string_view url, const std::string& destination);
+} // namespace local_file
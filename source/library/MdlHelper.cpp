@@ -12,16 +12,30 @@
 
 #include "DebugCodes.h"
 #include "OmniUsdResolver.h"
+#include "OmniUsdResolverCache.h"
+#include "utils/OmniClientUtils.h"
+#include "utils/PathUtils.h"
+#include "utils/PythonUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/Time.h"
 
 #include <pxr/base/tf/debug.h>
 #include <pxr/base/tf/diagnostic.h>
 #include <pxr/base/tf/envSetting.h>
 #include <pxr/base/tf/stringUtils.h>
 
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <OmniClient.h>
+
 PXR_NAMESPACE_OPEN_SCOPE
 TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_MDL_BUILTIN_BYPASS,
                       false,
@@ -98,37 +112,486 @@ TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_MDL_BUILTIN_PATHS,
                       "vray_maps.mdl,"
                       "vray_materials.mdl",
                       "Comma-separated list for determining MDL builtin materials");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_MDL_INDEX_ROOTS,
+                      "",
+                      "Semicolon-separated list of MDL search roots to index in the background. Every module found "
+                      "is treated as an MDL builtin and resolves without a round trip to the server");
 PXR_NAMESPACE_CLOSE_SCOPE
 PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace
 {
-static std::set<std::string> g_builtins;
+using EntryPtr = OmniUsdResolverCache::EntryPtr;
+using IndexedModules = std::unordered_map<std::string, EntryPtr>;
+
+/// An immutable open-addressed hash set of builtin MDL paths.
+///
+/// The set of names is never modified once published. omniUsdResolverSetMdlBuiltins and the MDL indexer build
+/// a new table and swap it in atomically, so readers never take a lock or see a partially filled table.
+/// The table also owns what each builtin resolved to. Each entry is set at most once and lives as long as the table,
+/// since what a builtin resolves to does not change for the life of the process.
+class BuiltinTable
+{
+public:
+    BuiltinTable(std::vector<std::string> builtins, const IndexedModules& indexed, const BuiltinTable* previous)
+        : _names(std::move(builtins))
+    {
+        _names.reserve(_names.size() + indexed.size());
+        for (const auto& module : indexed)
+        {
+            _names.push_back(module.first);
+        }
+        std::sort(_names.begin(), _names.end());
+        _names.erase(std::unique(_names.begin(), _names.end()), _names.end());
+
+        // Builtins that were already resolved stay resolved unless the index has a newer answer
+        _entries = std::make_unique<std::atomic<const EntryPtr*>[]>(_names.size());
+        for (size_t i = 0; i < _names.size(); ++i)
+        {
+            EntryPtr entry;
+            auto it = indexed.find(_names[i]);
+            if (it != indexed.end())
+            {
+                entry = it->second;
+            }
+            else if (previous)
+            {
+                entry = previous->GetEntry(_names[i]);
+            }
+            _entries[i].store(entry ? new EntryPtr(std::move(entry)) : nullptr, std::memory_order_relaxed);
+        }
+
+        // Keep the load factor at or below 50% so probe sequences stay short
+        size_t capacity = 16;
+        while (capacity < _names.size() * 2)
+        {
+            capacity *= 2;
+        }
+        _mask = capacity - 1;
+        _slots.assign(capacity, kEmpty);
+
+        for (uint32_t i = 0; i < _names.size(); ++i)
+        {
+            size_t slot = _Hash(_names[i]) & _mask;
+            while (_slots[slot] != kEmpty)
+            {
+                slot = (slot + 1) & _mask;
+            }
+            _slots[slot] = i;
+        }
+    }
+
+    ~BuiltinTable()
+    {
+        for (size_t i = 0; i < _names.size(); ++i)
+        {
+            delete _entries[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    BuiltinTable(const BuiltinTable&) = delete;
+    BuiltinTable& operator=(const BuiltinTable&) = delete;
+
+    bool Contains(std::string_view name) const
+    {
+        return _Find(name) != kEmpty;
+    }
+
+    /// Returns what \p name resolved to, or was indexed as, if anything
+    EntryPtr GetEntry(std::string_view name) const
+    {
+        const uint32_t index = _Find(name);
+        const EntryPtr* entry = index != kEmpty ? _entries[index].load(std::memory_order_acquire) : nullptr;
+        return entry ? *entry : nullptr;
+    }
+
+    /// Remembers what \p name resolved to. Nothing is stored if \p name is not in the table or already has an entry,
+    /// so an entry that readers may be copying is never replaced
+    void SetEntry(std::string_view name, const EntryPtr& entry) const
+    {
+        const uint32_t index = _Find(name);
+        if (index == kEmpty)
+        {
+            return;
+        }
+
+        auto stored = std::make_unique<EntryPtr>(entry);
+        const EntryPtr* expected = nullptr;
+        if (_entries[index].compare_exchange_strong(expected, stored.get(), std::memory_order_acq_rel))
+        {
+            stored.release();
+        }
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    static size_t _Hash(std::string_view name)
+    {
+        return std::hash<std::string_view>()(name);
+    }
+
+    uint32_t _Find(std::string_view name) const
+    {
+        for (size_t slot = _Hash(name) & _mask; _slots[slot] != kEmpty; slot = (slot + 1) & _mask)
+        {
+            if (_names[_slots[slot]] == name)
+            {
+                return _slots[slot];
+            }
+        }
+        return kEmpty;
+    }
+
+    std::vector<std::string> _names;
+    std::unique_ptr<std::atomic<const EntryPtr*>[]> _entries;
+    std::vector<uint32_t> _slots;
+    size_t _mask = 0;
+};
+
+std::atomic<const BuiltinTable*> g_builtins{ nullptr };
+
+// Guards the inputs to the builtin table
+std::mutex g_builtinsMutex;
+std::vector<std::string> g_configuredBuiltins;
+IndexedModules g_indexedModules;
+
+/// Epoch-based reclamation of replaced builtin tables.
+///
+/// Each thread that reads the builtin table has its own record, which holds the epoch it entered its read in, or 0
+/// outside of a read. A replaced table is freed once every record is outside of a read or entered it after the table
+/// was replaced. Readers only write their own record, so lookups stay wait-free and do not contend with each other.
+struct ReaderRecord
+{
+    alignas(64) std::atomic<uint64_t> epoch{ 0 };
+};
+
+struct ReaderRegistry
+{
+    std::mutex mutex;
+    std::vector<ReaderRecord*> records;
+};
+
+std::atomic<uint64_t> g_epoch{ 1 };
+
+// Never destroyed, since threads of other libraries can exit after static destruction
+ReaderRegistry& _GetReaders()
+{
+    static ReaderRegistry* readers = new ReaderRegistry();
+    return *readers;
+}
+
+class ThreadReader
+{
+public:
+    ThreadReader()
+    {
+        auto& readers = _GetReaders();
+        std::lock_guard<std::mutex> lock(readers.mutex);
+        readers.records.push_back(&_record);
+    }
+
+    ~ThreadReader()
+    {
+        auto& readers = _GetReaders();
+        std::lock_guard<std::mutex> lock(readers.mutex);
+        readers.records.erase(std::find(readers.records.begin(), readers.records.end(), &_record));
+    }
+
+    ReaderRecord& GetRecord()
+    {
+        return _record;
+    }
+
+private:
+    ReaderRecord _record;
+};
+
+/// Keeps the builtin table that was loaded during its lifetime from being freed. Read sections do not nest
+class ReadSection
+{
+public:
+    ReadSection() : _record(_GetRecord())
+    {
+        _record.epoch.store(g_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+
+    ~ReadSection()
+    {
+        _record.epoch.store(0, std::memory_order_release);
+    }
+
+    const BuiltinTable* GetBuiltins() const
+    {
+        return g_builtins.load(std::memory_order_seq_cst);
+    }
+
+private:
+    static ReaderRecord& _GetRecord()
+    {
+        static thread_local ThreadReader reader;
+        return reader.GetRecord();
+    }
+
+    ReaderRecord& _record;
+};
+
+/// \param keepResolved whether builtins resolved with the current table should stay resolved. This is false when
+/// the configured builtins change
+/// \note Called with g_builtinsMutex held, which is the only place the table is replaced
+void _PublishBuiltins(bool keepResolved)
+{
+    const BuiltinTable* current = g_builtins.load(std::memory_order_relaxed);
+    auto table = std::make_unique<const BuiltinTable>(
+        g_configuredBuiltins, g_indexedModules, keepResolved ? current : nullptr);
+    std::unique_ptr<const BuiltinTable> previous(g_builtins.exchange(table.release(), std::memory_order_seq_cst));
+    if (!previous)
+    {
+        return;
+    }
+
+    // Readers that entered before this epoch may still be using the previous table
+    const uint64_t epoch = g_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+    auto& readers = _GetReaders();
+    std::lock_guard<std::mutex> lock(readers.mutex);
+    for (const ReaderRecord* record : readers.records)
+    {
+        for (uint64_t readerEpoch = record->epoch.load(std::memory_order_seq_cst);
+             readerEpoch != 0 && readerEpoch < epoch; readerEpoch = record->epoch.load(std::memory_order_seq_cst))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
 
 struct PopulateBuiltinsFromEnv
 {
     PopulateBuiltinsFromEnv()
     {
-        const std::vector<std::string> paths = TfStringSplit(TfGetEnvSetting(OMNI_USD_RESOLVER_MDL_BUILTIN_PATHS), ",");
-        g_builtins.insert(paths.begin(), paths.end());
+        std::lock_guard<std::mutex> lock(g_builtinsMutex);
+        g_configuredBuiltins = TfStringSplit(TfGetEnvSetting(OMNI_USD_RESOLVER_MDL_BUILTIN_PATHS), ",");
+        _PublishBuiltins(false);
     };
 };
 static PopulateBuiltinsFromEnv g_populateBuiltinsFromEnv;
+
+/// Walks MDL search roots in the background and publishes every module it finds as a builtin,
+/// along with the entry it resolved to
+class MdlIndexer
+{
+public:
+    ~MdlIndexer()
+    {
+        Stop();
+    }
+
+    void Start(std::vector<std::string> roots)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _StopLocked();
+        _cancel = false;
+        _thread = std::thread(&MdlIndexer::_Run, this, std::move(roots));
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _StopLocked();
+    }
+
+    void Wait()
+    {
+        PyReleaseGil releaseGil;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_thread.joinable())
+        {
+            _thread.join();
+        }
+    }
+
+private:
+    // Guards against symlink cycles and runaway trees
+    static constexpr size_t kMaxDepth = 16;
+
+    struct ListedItem
+    {
+        std::string name;
+        uint32_t flags;
+        std::string version;
+        uint64_t modifiedTimeNs;
+        uint64_t size;
+    };
+
+    struct ListContext
+    {
+        std::string dir;
+        std::vector<ListedItem> items;
+    };
+
+    static void _ListCallback(void* userData,
+                              OmniClientResult result,
+                              uint32_t numEntries,
+                              struct OmniClientListEntry const* entries) noexcept
+    {
+        if (result != eOmniClientResult_Ok)
+        {
+            return;
+        }
+
+        auto& context = *static_cast<ListContext*>(userData);
+        context.items.reserve(numEntries);
+        for (uint32_t i = 0; i < numEntries; ++i)
+        {
+            context.items.push_back({ safeString(entries[i].relativePath), static_cast<uint32_t>(entries[i].flags),
+                                      safeString(entries[i].version), entries[i].modifiedTimeNs, entries[i].size });
+        }
+    }
+
+    void _StopLocked()
+    {
+        _cancel = true;
+        if (_thread.joinable())
+        {
+            PyReleaseGil releaseGil;
+            _thread.join();
+        }
+    }
+
+    void _Run(std::vector<std::string> roots)
+    {
+        // Roots are searched in order, so a module found under an earlier root wins
+        IndexedModules modules;
+        for (auto root : roots)
+        {
+            if (root.empty())
+            {
+                continue;
+            }
+            if (root.back() != '/')
+            {
+                root.push_back('/');
+            }
+
+            // Every directory at the same depth is listed at once
+            std::vector<std::string> dirs{ std::string() };
+            for (size_t depth = 0; depth < kMaxDepth && !dirs.empty() && !_cancel; ++depth)
+            {
+                std::vector<ListContext> contexts(dirs.size());
+                std::vector<OmniClientRequestId> requests;
+                requests.reserve(dirs.size());
+                for (size_t i = 0; i < dirs.size(); ++i)
+                {
+                    contexts[i].dir = std::move(dirs[i]);
+                    const std::string url = root + contexts[i].dir;
+                    requests.push_back(omniClientList(url.c_str(), &contexts[i], _ListCallback));
+                }
+                for (auto request : requests)
+                {
+                    omniClientWait(request);
+                }
+
+                dirs.clear();
+                for (const auto& context : contexts)
+                {
+                    for (const auto& item : context.items)
+                    {
+                        const std::string path = context.dir + item.name;
+                        if (item.flags & fOmniClientItem_CanHaveChildren)
+                        {
+                            dirs.push_back(path + '/');
+                        }
+                        else if (TfStringEndsWith(path, ".mdl") && modules.count(path) == 0)
+                        {
+                            modules.emplace(path, _MakeEntry(path, root + path, item));
+                        }
+                    }
+                }
+            }
+        }
+
+        if (_cancel)
+        {
+            return;
+        }
+
+        TF_DEBUG(OMNI_USD_RESOLVER_MDL)
+            .Msg("%s: indexed %zu MDL modules in %zu roots\n", TF_FUNC_NAME().c_str(), modules.size(), roots.size());
+
+        std::lock_guard<std::mutex> lock(g_builtinsMutex);
+        g_indexedModules = std::move(modules);
+        _PublishBuiltins(true);
+    }
+
+    static EntryPtr _MakeEntry(const std::string& modulePath, std::string url, const ListedItem& item)
+    {
+        auto entry = std::make_shared<OmniUsdResolverCache::Entry>();
+        entry->identifier = modulePath;
+
+        std::string buffer;
+        const UrlView urlView = breakUrlView(url, buffer);
+        entry->resolvedPath = urlView.local ? fixLocalPath(std::string(urlView.path)) : url;
+        entry->url = std::move(url);
+        entry->version = item.version;
+        entry->modifiedTime = convertFromTimeSinceUnixEpoch(std::chrono::nanoseconds(item.modifiedTimeNs));
+        entry->size = item.size;
+        return entry;
+    }
+
+    std::mutex _mutex;
+    std::thread _thread;
+    std::atomic<bool> _cancel{ false };
+};
+
+MdlIndexer g_indexer;
 }; // namespace
 
 OMNIUSDRESOLVER_EXPORT(void)
 omniUsdResolverSetMdlBuiltins(char const** builtins, size_t numBuiltins) OMNIUSDRESOLVER_NOEXCEPT
 {
-    g_builtins.clear();
+    std::vector<std::string> paths;
+    paths.reserve(numBuiltins);
     for (size_t i = 0; i < numBuiltins; i++)
     {
-        g_builtins.insert(safeString(builtins[i]));
+        paths.push_back(safeString(builtins[i]));
     }
+
+    std::lock_guard<std::mutex> lock(g_builtinsMutex);
+    g_configuredBuiltins = std::move(paths);
+    _PublishBuiltins(false);
+}
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverIndexMdlSearchRoots(char const** roots, size_t numRoots) OMNIUSDRESOLVER_NOEXCEPT
+{
+    std::vector<std::string> rootStrs;
+    rootStrs.reserve(numRoots);
+    for (size_t i = 0; i < numRoots; i++)
+    {
+        rootStrs.push_back(safeString(roots[i]));
+    }
+
+    if (rootStrs.empty())
+    {
+        g_indexer.Stop();
+
+        std::lock_guard<std::mutex> lock(g_builtinsMutex);
+        g_indexedModules.clear();
+        _PublishBuiltins(false);
+        return;
+    }
+
+    g_indexer.Start(std::move(rootStrs));
+}
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverWaitForMdlIndex() OMNIUSDRESOLVER_NOEXCEPT
+{
+    g_indexer.Wait();
 }
 
 namespace mdl_helper
 {
-bool IsMdlIdentifier(const std::string& assetPath)
+bool IsMdlIdentifier(std::string_view assetPath)
 {
     // XXX: This env var may no longer be necessary for Ar 2. This was added to Ar 1 to allow an MDL path,
     // i.e nvidia/aux_definitions.mdl, to pass through as-is all the way to resolve. This included
@@ -158,12 +621,63 @@ bool IsMdlIdentifier(const std::string& assetPath)
     // MDL asset paths that are not builtins but look like search paths (i.e #2) will be first looked for
     // relative to the layer then resolved via search paths. Finally, relative MDL asset paths will only be resolved
     // relative to the layer (i.e #3).
-    if (g_builtins.find(assetPath) != g_builtins.end())
+    ReadSection section;
+    const BuiltinTable* builtins = section.GetBuiltins();
+    if (builtins && builtins->Contains(assetPath))
     {
-        TF_DEBUG(OMNI_USD_RESOLVER_MDL).Msg("%s: %s is a builtin\n", TF_FUNC_NAME().c_str(), assetPath.c_str());
+        TF_DEBUG(OMNI_USD_RESOLVER_MDL)
+            .Msg("%s: %.*s is a builtin\n", TF_FUNC_NAME().c_str(), static_cast<int>(assetPath.size()), assetPath.data());
         return true;
     }
 
     return false;
 }
+
+OmniUsdResolverCache::EntryPtr GetResolvedBuiltin(std::string_view assetPath)
+{
+    // Modules found by the indexer are always returned. What a builtin resolved to is only ever stored with the
+    // bypass enabled, see SetResolvedBuiltin
+    ReadSection section;
+    const BuiltinTable* builtins = section.GetBuiltins();
+    return builtins ? builtins->GetEntry(assetPath) : nullptr;
+}
+
+void SetResolvedBuiltin(std::string_view assetPath, const OmniUsdResolverCache::EntryPtr& entry)
+{
+    // Without the bypass a builtin is resolved like any other search path, i.e next to the bound context first,
+    // so what it resolves to is not the same for every stage
+    static bool enabled = TfGetEnvSetting(OMNI_USD_RESOLVER_MDL_BUILTIN_BYPASS);
+    if (!enabled)
+    {
+        return;
+    }
+
+    ReadSection section;
+    if (const BuiltinTable* builtins = section.GetBuiltins())
+    {
+        builtins->SetEntry(assetPath, entry);
+    }
+}
+
+void IndexSearchRootsFromEnv()
+{
+    static std::once_flag once;
+    std::call_once(once,
+                   []()
+                   {
+                       std::vector<std::string> roots;
+                       for (const auto& root : TfStringSplit(TfGetEnvSetting(OMNI_USD_RESOLVER_MDL_INDEX_ROOTS), ";"))
+                       {
+                           if (!TfStringTrim(root).empty())
+                           {
+                               roots.push_back(TfStringTrim(root));
+                           }
+                       }
+
+                       if (!roots.empty())
+                       {
+                           g_indexer.Start(std::move(roots));
+                       }
+                   });
+}
 } // namespace mdl_helper
@@ -8,7 +8,9 @@
 // without an express license agreement from NVIDIA CORPORATION or
 // its affiliates is strictly prohibited.
 
-#include <string>
+#include "OmniUsdResolverCache.h"
+
+#include <string_view>
 
 namespace mdl_helper
 {
@@ -21,7 +23,23 @@ namespace mdl_helper
 /// If not, this function will return false
 /// \param assetPath the path to determine if it is a MDL identifier
 /// \return true if the assetPath is an MDL identifier. Otherwise, false.
+/// \note Lookups are wait-free and safe to make while omniUsdResolverSetMdlBuiltins replaces the builtins
+bool IsMdlIdentifier(std::string_view assetPath);
+
+/// \brief Returns what the builtin \p assetPath resolved to, or what the background MDL indexer found for it
+/// \note The indexer only runs once omniUsdResolverIndexMdlSearchRoots is called or
+/// OMNI_USD_RESOLVER_MDL_INDEX_ROOTS is set. Indexed modules are returned whether or not
+/// OMNI_USD_RESOLVER_MDL_BUILTIN_BYPASS is enabled
+/// \return the entry, or nullptr if \p assetPath is not a builtin or has not been resolved yet
+OmniUsdResolverCache::EntryPtr GetResolvedBuiltin(std::string_view assetPath);
+
+/// \brief Remembers what the builtin \p assetPath resolved to for the life of the process, or until
+/// omniUsdResolverSetMdlBuiltins changes the builtins. Nothing is stored if \p assetPath is not a builtin
+/// or OMNI_USD_RESOLVER_MDL_BUILTIN_BYPASS is disabled
+void SetResolvedBuiltin(std::string_view assetPath, const OmniUsdResolverCache::EntryPtr& entry);
 
-bool IsMdlIdentifier(const std::string& assetPath);
+/// \brief Starts indexing the roots set in OMNI_USD_RESOLVER_MDL_INDEX_ROOTS in the background.
+/// Only the first call has any effect
+void IndexSearchRootsFromEnv();
 
 } // namespace mdl_helper
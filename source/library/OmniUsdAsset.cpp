@@ -10,17 +10,66 @@
 
 #include "OmniUsdAsset.h"
 
+#include "BufferPool.h"
 #include "DebugCodes.h"
+#include "IoBackend.h"
 #include "Notifications.h"
+#include "Prefetch.h"
 #include "utils/PathUtils.h"
 #include "utils/PythonUtils.h"
 
 #include <pxr/base/arch/errno.h>
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/envSetting.h>
 
 #include <OmniClient.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_READ_AHEAD_SIZE,
+                      0,
+                      "Maximum number of bytes read ahead when an asset is read sequentially. Zero, the default, "
+                      "disables read-ahead");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_IN_MEMORY_ASSET_SIZE,
+                      0,
+                      "Assets smaller than this number of bytes are read into memory when they are opened. Zero "
+                      "disables reading assets into memory");
+PXR_NAMESPACE_CLOSE_SCOPE
 PXR_NAMESPACE_USING_DIRECTIVE
 
+namespace
+{
+// The first read-ahead window, which doubles on every refill up to OMNI_USD_RESOLVER_READ_AHEAD_SIZE
+constexpr size_t kMinReadAhead = 64 * 1024;
+
+// Number of reads in a row that must continue where the previous read ended before reading ahead
+constexpr size_t kSequentialReads = 2;
+
+// Reads with io_uring are split into ranges of at least this many bytes, and into no more than kMaxIoUringRanges
+constexpr size_t kIoUringRangeSize = 1024 * 1024;
+constexpr size_t kMaxIoUringRanges = 16;
+
+std::atomic<size_t> g_inMemoryAssetSize{ static_cast<size_t>(
+    std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_IN_MEMORY_ASSET_SIZE), 0)) };
+
+std::atomic<size_t> g_maxReadAhead{ static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_READ_AHEAD_SIZE), 0)) };
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetInMemoryAssetSize(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT
+{
+    g_inMemoryAssetSize.store(bytes, std::memory_order_relaxed);
+}
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetReadAheadSize(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT
+{
+    g_maxReadAhead.store(bytes, std::memory_order_relaxed);
+}
+
 std::shared_ptr<OmniUsdAsset> OmniUsdAsset::Open(const ArResolvedPath& resolvedPath)
 {
     TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
@@ -48,16 +97,31 @@ std::shared_ptr<OmniUsdAsset> OmniUsdAsset::Open(const ArResolvedPath& resolvedP
     //    this environment variable I ran into multiple crashes. Since USDC_USE_ASSET is disabled by default
     //    the choice was made to just use omniClientGetLocalFile
     std::string filePath;
-    inputData.clientRequestId =
-        omniClientGetLocalFile(inputData.url.c_str(), true, &filePath,
-                               [](void* userData, OmniClientResult result, char const* localFilePath) noexcept
-                               {
-                                   if (result == eOmniClientResult_Ok)
+    prefetch::Result prefetched;
+    if (prefetch::Take(inputData.url, prefetched))
+    {
+        // The download was started by omniUsdResolverPrefetch, and this asset is now responsible for it
+        filePath = std::move(prefetched.localFile);
+        inputData.clientRequestId = prefetched.requestId;
+    }
+
+    if (filePath.empty())
+    {
+        if (inputData.clientRequestId)
+        {
+            omniClientStop(inputData.clientRequestId);
+        }
+        inputData.clientRequestId =
+            omniClientGetLocalFile(inputData.url.c_str(), true, &filePath,
+                                   [](void* userData, OmniClientResult result, char const* localFilePath) noexcept
                                    {
-                                       *static_cast<std::string*>(userData) = localFilePath;
-                                   }
-                               });
-    omniClientWait(inputData.clientRequestId);
+                                       if (result == eOmniClientResult_Ok)
+                                       {
+                                           *static_cast<std::string*>(userData) = localFilePath;
+                                       }
+                                   });
+        omniClientWait(inputData.clientRequestId);
+    }
 
     if (filePath.empty())
     {
@@ -67,8 +131,14 @@ std::shared_ptr<OmniUsdAsset> OmniUsdAsset::Open(const ArResolvedPath& resolvedP
     }
 
     inputData.localFile = fixLocalPath(filePath);
-    inputData.file = ArchOpenFile(inputData.localFile.c_str(), "rb");
-    if (inputData.file)
+    inputData.file = local_file::Open(inputData.localFile, inputData.url);
+    const size_t inMemoryAssetSize = g_inMemoryAssetSize.load(std::memory_order_relaxed);
+    if (inputData.file && static_cast<size_t>(inputData.file->GetSize()) < inMemoryAssetSize)
+    {
+        _ReadIntoMemory(inputData);
+    }
+
+    if (inputData.file || inputData.buffer)
     {
         eventFinished = eOmniUsdResolverEventState_Success;
         auto usdAsset = std::make_shared<OmniUsdAsset>(std::move(inputData));
@@ -79,11 +149,37 @@ std::shared_ptr<OmniUsdAsset> OmniUsdAsset::Open(const ArResolvedPath& resolvedP
     return nullptr;
 }
 
+void OmniUsdAsset::_ReadIntoMemory(OmniUsdReadableData& inputData)
+{
+    const size_t size = static_cast<size_t>(inputData.file->GetSize());
+    std::shared_ptr<char> buffer = buffer_pool::Acquire(size);
+    if (ArchPRead(inputData.file->GetFile(), buffer.get(), size, 0) != static_cast<int64_t>(size))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: unable to read %s into memory. Reading from %s instead\n", TF_FUNC_NAME().c_str(),
+                 inputData.url.c_str(), inputData.localFile.c_str());
+        return;
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: read %s into memory (%zu bytes)\n", TF_FUNC_NAME().c_str(), inputData.url.c_str(), size);
+
+    // Nothing is read from the local file again, so neither the file nor the request need to be kept
+    inputData.buffer = std::move(buffer);
+    inputData.size = size;
+    inputData.file.reset();
+    if (inputData.clientRequestId)
+    {
+        omniClientStop(inputData.clientRequestId);
+        inputData.clientRequestId = 0;
+    }
+}
+
 OmniUsdAsset::OmniUsdAsset(OmniUsdReadableData&& inputData) : _inputData(std::move(inputData))
 {
     TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s\n", TF_FUNC_NAME().c_str(), _inputData.url.c_str());
 
-    if (!_inputData.file)
+    if (!_inputData.file && !_inputData.buffer)
     {
         TF_CODING_ERROR("Invalid handle to local file");
     }
@@ -91,11 +187,6 @@ OmniUsdAsset::OmniUsdAsset(OmniUsdReadableData&& inputData) : _inputData(std::mo
 
 OmniUsdAsset::~OmniUsdAsset()
 {
-    if (_inputData.file)
-    {
-        fclose(_inputData.file);
-        _inputData.file = nullptr;
-    }
     if (_inputData.clientRequestId)
     {
         omniClientStop(_inputData.clientRequestId);
@@ -105,50 +196,177 @@ OmniUsdAsset::~OmniUsdAsset()
 
 size_t OmniUsdAsset::GetSize() const
 {
-    return ArchGetFileLength(_inputData.file);
+    return _inputData.buffer ? _inputData.size : _inputData.file->GetSize();
 }
 
 std::shared_ptr<const char> OmniUsdAsset::GetBuffer() const
 {
-    ArchConstFileMapping mapping = ArchMapFileReadOnly(_inputData.file);
-    if (!mapping)
+    if (_inputData.buffer)
+    {
+        return _inputData.buffer;
+    }
+
+    auto buffer = _inputData.file->GetBuffer();
+    if (!buffer)
     {
         TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
             .Msg("%s: Unable to create memory mapping of %s (%s)\n", TF_FUNC_NAME().c_str(), _inputData.url.c_str(),
                  _inputData.localFile.c_str());
-        return nullptr;
     }
+    return buffer;
+}
 
-    struct _Deleter
+size_t OmniUsdAsset::Read(void* out, size_t count, size_t offset) const
+{
+    if (_inputData.buffer)
     {
-        explicit _Deleter(ArchConstFileMapping&& mapping) : _mapping(new ArchConstFileMapping(std::move(mapping)))
+        if (offset >= _inputData.size)
         {
+            return 0;
         }
+        count = std::min(count, _inputData.size - offset);
+        memcpy(out, _inputData.buffer.get() + offset, count);
+        return count;
+    }
+
+    // Large reads gain nothing from going through the read-ahead buffer. Files advised for random access, like crate
+    // files, are not read sequentially often enough to make up for the buffer
+    const size_t maxReadAhead = g_maxReadAhead.load(std::memory_order_relaxed);
+    if (count >= maxReadAhead || _inputData.file->IsRandomAccess())
+    {
+        return _PRead(out, count, offset);
+    }
 
-        void operator()(const char* b)
+    // The mutex only guards the detection state and the buffer pointer. Reads, and copies out of the buffer, happen
+    // outside of it so that threads reading different parts of the asset do not wait on each other
+    const size_t fileSize = static_cast<size_t>(_inputData.file->GetSize());
+    std::shared_ptr<const std::vector<char>> buffer;
+    size_t bufferOffset = 0;
+    size_t window = 0;
+    {
+        std::lock_guard<std::mutex> lock(_readAheadMutex);
+        ReadAhead& readAhead = _readAhead;
+        if (readAhead.buffer && offset >= readAhead.bufferOffset &&
+            offset + count <= readAhead.bufferOffset + readAhead.buffer->size())
         {
-            _mapping.reset();
+            buffer = readAhead.buffer;
+            bufferOffset = readAhead.bufferOffset;
+            readAhead.nextOffset = offset + count;
+            if (readAhead.nextOffset >= fileSize)
+            {
+                // The whole asset has been read, so the buffer is unlikely to be needed again
+                readAhead.buffer.reset();
+            }
         }
+        else
+        {
+            if (offset == readAhead.nextOffset)
+            {
+                readAhead.sequentialReads++;
+            }
+            else
+            {
+                // The buffer is released with the detection so that assets which stopped reading sequentially do not
+                // hold on to it
+                readAhead.buffer.reset();
+                readAhead.sequentialReads = 0;
+                readAhead.window = 0;
+            }
+            readAhead.nextOffset = offset + count;
 
-        std::shared_ptr<ArchConstFileMapping> _mapping;
-    };
+            // Only one thread refills the buffer at a time, the others read what they asked for directly
+            if (readAhead.sequentialReads >= kSequentialReads && !readAhead.refilling)
+            {
+                readAhead.refilling = true;
+                readAhead.window = std::min(readAhead.window ? readAhead.window * 2 : kMinReadAhead, maxReadAhead);
+                window = readAhead.window;
+            }
+        }
+    }
+
+    if (buffer)
+    {
+        memcpy(out, buffer->data() + (offset - bufferOffset), count);
+        return count;
+    }
+
+    if (!window)
+    {
+        return _PRead(out, count, offset);
+    }
+
+    auto refill = std::make_shared<std::vector<char>>(std::max(window, count));
+    const size_t numRead = _PRead(refill->data(), refill->size(), offset);
+    refill->resize(numRead);
+
+    // Let the OS start fetching the next window while this one is consumed
+    if (offset + numRead < fileSize)
+    {
+        ArchFileAdvise(_inputData.file->GetFile(), offset + numRead, std::min(window * 2, maxReadAhead),
+                       ArchFileAdviceWillNeed);
+    }
+
+    const size_t numCopied = std::min(count, numRead);
+    memcpy(out, refill->data(), numCopied);
 
-    const char* buffer = mapping.get();
-    return { buffer, _Deleter(std::move(mapping)) };
+    std::lock_guard<std::mutex> lock(_readAheadMutex);
+    _readAhead.refilling = false;
+
+    // A read somewhere else while the buffer was filled reset the detection, which leaves the buffer with no use
+    if (_readAhead.sequentialReads >= kSequentialReads && offset + numRead < fileSize)
+    {
+        _readAhead.buffer = std::move(refill);
+        _readAhead.bufferOffset = offset;
+    }
+    return numCopied;
 }
 
-size_t OmniUsdAsset::Read(void* out, size_t count, size_t offset) const
+size_t OmniUsdAsset::_PRead(void* out, size_t count, size_t offset) const
 {
-    int64_t numRead = ArchPRead(_inputData.file, out, count, offset);
-    if (numRead == -1)
+    // With io_uring large reads are split into ranges that the kernel reads in parallel
+    size_t numRanges = 1;
+    if (count >= 2 * kIoUringRangeSize && io_backend::IsUsingIoUring())
+    {
+        numRanges = std::min(count / kIoUringRangeSize, kMaxIoUringRanges);
+    }
+
+    const size_t rangeSize = (count + numRanges - 1) / numRanges;
+    std::array<io_backend::ReadRange, kMaxIoUringRanges> ranges;
+    for (size_t i = 0; i < numRanges; ++i)
     {
-        TF_RUNTIME_ERROR("Error occurred reading local file for %s: %s", _inputData.url.c_str(), ArchStrerror().c_str());
-        return 0;
+        ranges[i].out = static_cast<char*>(out) + i * rangeSize;
+        ranges[i].offset = offset + i * rangeSize;
+        ranges[i].count = std::min(rangeSize, count - i * rangeSize);
+    }
+    io_backend::Read(_inputData.file->GetFile(), ranges.data(), numRanges);
+
+    size_t numRead = 0;
+    for (size_t i = 0; i < numRanges; ++i)
+    {
+        const io_backend::ReadRange& range = ranges[i];
+        if (range.numRead == -1)
+        {
+            TF_RUNTIME_ERROR(
+                "Error occurred reading local file for %s: %s", _inputData.url.c_str(), ArchStrerror().c_str());
+            return 0;
+        }
+
+        // Ranges past the end of the file read nothing
+        numRead += static_cast<size_t>(range.numRead);
+        if (static_cast<size_t>(range.numRead) < range.count)
+        {
+            break;
+        }
     }
     return numRead;
 }
 
 std::pair<FILE*, size_t> OmniUsdAsset::GetFileUnsafe() const
 {
-    return std::make_pair(_inputData.file, 0);
+    // Assets read into memory have no file, so USD reads them with GetBuffer or Read instead
+    if (_inputData.buffer)
+    {
+        return std::make_pair(nullptr, 0);
+    }
+    return std::make_pair(_inputData.file->GetFile(), 0);
 }
@@ -10,24 +10,34 @@
 
 #pragma once
 
+#include "LocalFile.h"
 #include "UsdIncludes.h"
 
 #include <OmniClient.h>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 struct OmniUsdReadableData
 {
     std::string url;
     std::string localFile;
-    FILE* file = nullptr;
+    local_file::SharedFilePtr file;
     OmniClientRequestId clientRequestId = 0;
+
+    // Set instead of file for assets that were read into memory
+    std::shared_ptr<const char> buffer;
+    size_t size = 0;
 };
 
 /// \brief A ArAsset implementation that allows reading assets
 /// directly from the client-library to Omniverse
 ///
 /// In order to take advantage of memory mapped files and local caching, assets
-/// are first written to a local file cache on disk and then memory mapped from that file
+/// are first written to a local file cache on disk and then memory mapped from that file.
+/// The local file, and its mapping, are shared by every asset that reads it. Assets smaller than
+/// omniUsdResolverSetInMemoryAssetSize are instead read into memory when they are opened, and hold
+/// neither the local file nor the client-library request
 class OmniUsdAsset final : public ArAsset
 {
 public:
@@ -40,6 +50,12 @@ public:
     /// Opens the resolved asset for reading. Returns nullptr if the asset can not be read
     static std::shared_ptr<OmniUsdAsset> Open(const ArResolvedPath& resolvedPath);
 
+    /// Returns the URL the asset was opened from
+    const std::string& GetUrl() const
+    {
+        return _inputData.url;
+    }
+
     /// Returns the total number of bytes for the asset
     virtual size_t GetSize() const override;
 
@@ -47,6 +63,10 @@ public:
     virtual std::shared_ptr<const char> GetBuffer() const override;
 
     /// \brief Reads data from the asset
+    ///
+    /// When read-ahead is enabled, small reads that continue where the previous read ended are served from a
+    /// read-ahead buffer, which grows with every refill while the reads stay sequential. Files advised for random
+    /// access are never read ahead
     /// \param[out] out holds the data that was read from the asset
     /// \param count the number of bytes to read
     /// \param offset the offset for \p out to begin reading the asset to
@@ -56,5 +76,22 @@ public:
     virtual std::pair<FILE*, size_t> GetFileUnsafe() const override;
 
 private:
+    struct ReadAhead
+    {
+        std::shared_ptr<const std::vector<char>> buffer;
+        size_t bufferOffset = 0;
+        size_t nextOffset = 0;
+        size_t sequentialReads = 0;
+        size_t window = 0;
+        bool refilling = false;
+    };
+
+    static void _ReadIntoMemory(OmniUsdReadableData& inputData);
+
+    size_t _PRead(void* out, size_t count, size_t offset) const;
+
     OmniUsdReadableData _inputData;
+
+    mutable std::mutex _readAheadMutex;
+    mutable ReadAhead _readAhead;
 };
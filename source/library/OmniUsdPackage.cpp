@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "OmniUsdPackage.h"
+
+#include "DebugCodes.h"
+
+#include <pxr/base/tf/envSetting.h>
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_PACKAGE_CACHE_SIZE,
+                      32,
+                      "Maximum number of packages, i.e .usdz archives, kept open so the files inside of them can be "
+                      "read without opening the package again. Zero disables the package cache");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+struct CachedPackage
+{
+    std::string url;
+    std::string version;
+    std::shared_ptr<OmniUsdPackage> package;
+};
+
+// Least recently used packages are at the back of g_lru
+std::mutex g_mutex;
+std::list<CachedPackage> g_lru;
+std::unordered_map<std::string, std::list<CachedPackage>::iterator> g_packages;
+
+size_t _GetCacheSize()
+{
+    static const size_t cacheSize =
+        static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_PACKAGE_CACHE_SIZE), 0));
+    return cacheSize;
+}
+
+// Zip records are little-endian
+uint32_t _Read16(const char* data)
+{
+    const auto bytes = reinterpret_cast<const unsigned char*>(data);
+    return bytes[0] | (bytes[1] << 8);
+}
+
+uint32_t _Read32(const char* data)
+{
+    const auto bytes = reinterpret_cast<const unsigned char*>(data);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uint32_t(bytes[3]) << 24);
+}
+
+constexpr uint32_t kEndOfCentralDirectorySignature = 0x06054b50;
+constexpr uint32_t kCentralDirectorySignature = 0x02014b50;
+constexpr uint32_t kLocalFileSignature = 0x04034b50;
+constexpr size_t kEndOfCentralDirectorySize = 22;
+constexpr size_t kCentralDirectoryHeaderSize = 46;
+constexpr size_t kLocalFileHeaderSize = 30;
+constexpr size_t kMaxCommentSize = 0xffff;
+} // namespace
+
+OmniUsdPackage::OmniUsdPackage(std::shared_ptr<OmniUsdAsset> asset) : _asset(std::move(asset))
+{
+}
+
+std::shared_ptr<OmniUsdPackage> OmniUsdPackage::Open(const ArResolvedPath& resolvedPath, const std::string& version)
+{
+    const std::string& url = resolvedPath.GetPathString();
+    const size_t cacheSize = _GetCacheSize();
+
+    // A package of an older version is released outside of the lock once it has been replaced
+    std::shared_ptr<OmniUsdPackage> stale;
+    if (cacheSize > 0)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_packages.find(url);
+        if (it != g_packages.end())
+        {
+            g_lru.splice(g_lru.begin(), g_lru, it->second);
+            if (it->second->version == version)
+            {
+                TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s (cached)\n", TF_FUNC_NAME().c_str(), url.c_str());
+                return it->second->package;
+            }
+
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                .Msg("%s: %s changed since it was cached\n", TF_FUNC_NAME().c_str(), url.c_str());
+            stale = it->second->package;
+        }
+    }
+
+    auto asset = OmniUsdAsset::Open(resolvedPath);
+    if (!asset)
+    {
+        return nullptr;
+    }
+    auto package = std::make_shared<OmniUsdPackage>(std::move(asset));
+
+    if (cacheSize > 0)
+    {
+        // Packages that are dropped from the cache are released outside of the lock
+        std::list<CachedPackage> evicted;
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto inserted = g_packages.emplace(url, g_lru.end());
+        if (!inserted.second)
+        {
+            auto cached = inserted.first->second;
+            g_lru.splice(g_lru.begin(), g_lru, cached);
+            if (cached->version == version)
+            {
+                // Another thread opened the same package
+                return cached->package;
+            }
+            cached->version = version;
+            cached->package = package;
+            return package;
+        }
+        g_lru.push_front(CachedPackage{ url, version, package });
+        inserted.first->second = g_lru.begin();
+
+        while (g_lru.size() > cacheSize)
+        {
+            g_packages.erase(g_lru.back().url);
+            evicted.splice(evicted.begin(), g_lru, std::prev(g_lru.end()));
+        }
+    }
+
+    return package;
+}
+
+void OmniUsdPackage::Remove(const std::string& url)
+{
+    std::shared_ptr<OmniUsdPackage> removed;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_packages.find(url);
+    if (it != g_packages.end())
+    {
+        removed = std::move(it->second->package);
+        g_lru.erase(it->second);
+        g_packages.erase(it);
+    }
+}
+
+void OmniUsdPackage::Clear()
+{
+    std::list<CachedPackage> removed;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_packages.clear();
+    removed.swap(g_lru);
+}
+
+std::shared_ptr<ArAsset> OmniUsdPackage::OpenPackagedAsset(const std::string& packagedPath) const
+{
+    std::call_once(_indexOnce, [this] { _Index(); });
+
+    auto it = _entries.find(packagedPath);
+    if (it == _entries.end())
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: %s is not stored in the package\n", TF_FUNC_NAME().c_str(), packagedPath.c_str());
+        return nullptr;
+    }
+
+    return std::make_shared<OmniUsdPackagedAsset>(_asset, it->second);
+}
+
+void OmniUsdPackage::_Index() const
+{
+    auto buffer = _asset->GetBuffer();
+    const size_t size = _asset->GetSize();
+    if (!buffer || size < kEndOfCentralDirectorySize)
+    {
+        return;
+    }
+    const char* data = buffer.get();
+
+    // The end of central directory record is followed by a comment of up to 64 KiB
+    size_t eocd = size - kEndOfCentralDirectorySize;
+    const size_t eocdEnd = size > kEndOfCentralDirectorySize + kMaxCommentSize ?
+                               size - kEndOfCentralDirectorySize - kMaxCommentSize :
+                               0;
+    while (_Read32(data + eocd) != kEndOfCentralDirectorySignature)
+    {
+        if (eocd == eocdEnd)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: no central directory found\n", TF_FUNC_NAME().c_str());
+            return;
+        }
+        --eocd;
+    }
+
+    const size_t numEntries = _Read16(data + eocd + 10);
+    const size_t directorySize = _Read32(data + eocd + 12);
+    size_t position = _Read32(data + eocd + 16);
+    if (position > eocd || directorySize > eocd - position)
+    {
+        return;
+    }
+
+    const size_t directoryEnd = position + directorySize;
+    _entries.reserve(numEntries);
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        if (directoryEnd - position < kCentralDirectoryHeaderSize ||
+            _Read32(data + position) != kCentralDirectorySignature)
+        {
+            break;
+        }
+
+        const char* header = data + position;
+        const uint32_t method = _Read16(header + 10);
+        const size_t compressedSize = _Read32(header + 20);
+        const size_t uncompressedSize = _Read32(header + 24);
+        const size_t nameSize = _Read16(header + 28);
+        const size_t extraSize = _Read16(header + 30);
+        const size_t commentSize = _Read16(header + 32);
+        const size_t localHeader = _Read32(header + 42);
+
+        const size_t recordSize = kCentralDirectoryHeaderSize + nameSize + extraSize + commentSize;
+        if (directoryEnd - position < recordSize)
+        {
+            break;
+        }
+        position += recordSize;
+
+        // usdz only allows uncompressed files, and the sizes of zip64 entries are not in this record
+        if (method != 0 || compressedSize != uncompressedSize || localHeader > size - kLocalFileHeaderSize ||
+            _Read32(data + localHeader) != kLocalFileSignature)
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.offset = localHeader + kLocalFileHeaderSize + _Read16(data + localHeader + 26) +
+                       _Read16(data + localHeader + 28);
+        entry.size = uncompressedSize;
+        if (entry.offset > size || entry.size > size - entry.offset)
+        {
+            continue;
+        }
+
+        _entries.emplace(std::string(header + kCentralDirectoryHeaderSize, nameSize), entry);
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: indexed %zu files in %s\n", TF_FUNC_NAME().c_str(), _entries.size(), _asset->GetUrl().c_str());
+}
+
+OmniUsdPackagedAsset::OmniUsdPackagedAsset(std::shared_ptr<OmniUsdAsset> package, const OmniUsdPackage::Entry& entry)
+    : _package(std::move(package)), _entry(entry)
+{
+}
+
+size_t OmniUsdPackagedAsset::GetSize() const
+{
+    return _entry.size;
+}
+
+std::shared_ptr<const char> OmniUsdPackagedAsset::GetBuffer() const
+{
+    auto buffer = _package->GetBuffer();
+    if (!buffer)
+    {
+        return nullptr;
+    }
+    return std::shared_ptr<const char>(buffer, buffer.get() + _entry.offset);
+}
+
+size_t OmniUsdPackagedAsset::Read(void* out, size_t count, size_t offset) const
+{
+    if (offset >= _entry.size)
+    {
+        return 0;
+    }
+    return _package->Read(out, std::min(count, _entry.size - offset), _entry.offset + offset);
+}
+
+std::pair<FILE*, size_t> OmniUsdPackagedAsset::GetFileUnsafe() const
+{
+    auto file = _package->GetFileUnsafe();
+    if (!file.first)
+    {
+        return file;
+    }
+    return std::make_pair(file.first, file.second + _entry.offset);
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdAsset.h"
+#include "UsdIncludes.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// \brief A package, i.e a .usdz archive, along with an index of the files stored in it
+///
+/// Usd opens the package every time it opens a file inside of it. Outside of an ArResolverScopedCache the package
+/// would be looked up in the local file cache, opened and scanned for every texture it contains. Packages are
+/// instead cached by URL, and their zip central directory is parsed once, so every file inside a package is read from
+/// the single shared mapping of its local file. A cached package is opened again once its resolved version changes.
+class OmniUsdPackage
+{
+public:
+    /// The location of a file stored in the package
+    struct Entry
+    {
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    explicit OmniUsdPackage(std::shared_ptr<OmniUsdAsset> asset);
+
+    OmniUsdPackage(const OmniUsdPackage&) = delete;
+    OmniUsdPackage& operator=(const OmniUsdPackage&) = delete;
+
+    /// Returns the package at \p resolvedPath, opening it if the package is not cached for \p version. A package
+    /// cached for another version is replaced. Returns nullptr if the package can not be opened
+    static std::shared_ptr<OmniUsdPackage> Open(const ArResolvedPath& resolvedPath, const std::string& version);
+
+    /// Removes the cached package at \p url, i.e because it is about to be written
+    static void Remove(const std::string& url);
+
+    /// Removes every cached package
+    static void Clear();
+
+    /// Returns the asset for the whole package
+    const std::shared_ptr<OmniUsdAsset>& GetAsset() const
+    {
+        return _asset;
+    }
+
+    /// Opens the file at \p packagedPath as a view of the package that shares its buffer and local file.
+    /// Returns nullptr if the file is not in the package or is compressed, which usdz does not allow
+    std::shared_ptr<ArAsset> OpenPackagedAsset(const std::string& packagedPath) const;
+
+private:
+    void _Index() const;
+
+    const std::shared_ptr<OmniUsdAsset> _asset;
+
+    mutable std::once_flag _indexOnce;
+    mutable std::unordered_map<std::string, Entry> _entries;
+};
+
+/// \brief A ArAsset implementation for a file stored in a package
+///
+/// Files in usdz packages are stored uncompressed, so the asset is a range of the package asset and nothing is copied
+class OmniUsdPackagedAsset final : public ArAsset
+{
+public:
+    OmniUsdPackagedAsset(std::shared_ptr<OmniUsdAsset> package, const OmniUsdPackage::Entry& entry);
+
+    /// Returns the total number of bytes for the asset
+    virtual size_t GetSize() const override;
+
+    /// Returns the buffer of data for the asset, which points into the buffer of the package
+    virtual std::shared_ptr<const char> GetBuffer() const override;
+
+    /// \brief Reads data from the asset
+    /// \param[out] out holds the data that was read from the asset
+    /// \param count the number of bytes to read
+    /// \param offset the offset for \p out to begin reading the asset to
+    /// \return the number of bytes read from the asset
+    virtual size_t Read(void* out, size_t count, size_t offset) const override;
+
+    /// Returns the local file of the package and the offset of this asset within it
+    virtual std::pair<FILE*, size_t> GetFileUnsafe() const override;
+
+private:
+    const std::shared_ptr<OmniUsdAsset> _package;
+    const OmniUsdPackage::Entry _entry;
+};
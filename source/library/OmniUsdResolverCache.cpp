@@ -10,35 +10,445 @@
 
 #include "OmniUsdResolverCache.h"
 
+#include "CacheKey.h"
+#include "DebugCodes.h"
+#include "OmniUsdResolver.h"
+
+#include <pxr/base/tf/debug.h>
+#include <pxr/base/tf/envSetting.h>
+
 #include <tbb/concurrent_hash_map.h>
 
-bool OmniUsdResolverCache::Get(const std::string& key, Entry& entry) const
+#include <algorithm>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_CACHE_BUDGET,
+                      0,
+                      "Approximate number of bytes a resolve cache may use before entries are evicted. Zero is unbounded");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+std::atomic<size_t> g_defaultBudget{ static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_CACHE_BUDGET), 0)) };
+
+// The clock is compacted once more than half of it, and at least this many keys, are stale
+constexpr size_t kMinStaleClockKeys = 1024;
+
+size_t _GetEntryBytes(const std::string& key, const OmniUsdResolverCache::Entry& entry)
+{
+    // This is an estimate. It counts the key, which the map and the clock share, plus the node overhead
+    constexpr size_t kOverhead = 128;
+    return kOverhead + key.capacity() + sizeof(entry) + entry.identifier.capacity() + entry.url.capacity() +
+           entry.resolvedPath.capacity() + entry.version.capacity();
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetCacheBudget(size_t bytes) OMNIUSDRESOLVER_NOEXCEPT
+{
+    OmniUsdResolverCache::SetDefaultBudget(bytes);
+}
+
+void OmniUsdResolverCache::SetDefaultBudget(size_t bytes)
+{
+    g_defaultBudget.store(bytes, std::memory_order_relaxed);
+}
+
+size_t OmniUsdResolverCache::GetDefaultBudget()
 {
+    return g_defaultBudget.load(std::memory_order_relaxed);
+}
+
+OmniUsdResolverCache::EntryPtr OmniUsdResolverCache::Get(std::string_view key) const
+{
+    std::string buffer;
+    key = cache_key::Canonicalize(key, buffer);
+
     Cache::const_accessor accessor;
-    bool result = _cache.find(accessor, key);
-    if (result)
+    if (_cache.find(accessor, key) && _IsValid(accessor->second))
     {
-        entry.identifier = accessor->second.identifier;
-        entry.url = accessor->second.url;
-        entry.resolvedPath = accessor->second.resolvedPath;
-        entry.version = accessor->second.version;
-        entry.modifiedTime = accessor->second.modifiedTime;
-        entry.size = accessor->second.size;
+        // Avoid dirtying the cache line when the bit is already set, or when nothing is ever evicted
+        if (!accessor->second.referenced.load(std::memory_order_relaxed) && _GetBudget() != 0)
+        {
+            accessor->second.referenced.store(true, std::memory_order_relaxed);
+        }
+        accessor->second.hits.fetch_add(1, std::memory_order_relaxed);
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        return accessor->second.entry;
     }
 
-    return result;
+    _misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
 }
 
-void OmniUsdResolverCache::Add(const std::string& key, const Entry& entry)
+void OmniUsdResolverCache::Add(std::string_view key, EntryPtr entry, Clock::duration ttl)
 {
+    if (!entry)
+    {
+        return;
+    }
+
+    std::string buffer;
+    auto ownedKey = std::make_shared<const std::string>(cache_key::Canonicalize(key, buffer));
+    const size_t bytes = _GetEntryBytes(*ownedKey, *entry);
+
+    ClockKey clockKey;
+    {
+        Cache::accessor accessor;
+        if (_cache.insert(accessor, std::string_view(*ownedKey)))
+        {
+            clockKey = ownedKey;
+            _entries.fetch_add(1, std::memory_order_relaxed);
+
+            // The inserted key is a view of ownedKey so it has to live as long as the entry
+            accessor->second.key = std::move(ownedKey);
+        }
+        else if (_IsValid(accessor->second))
+        {
+            return;
+        }
+
+        // An entry that has expired, or was invalidated by Clear, is treated as not present
+        _footprint.fetch_add(bytes, std::memory_order_relaxed);
+        _footprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+        accessor->second.entry = std::move(entry);
+        accessor->second.expires = ttl == Clock::duration::zero() ? Clock::time_point::max() : Clock::now() + ttl;
+        accessor->second.generation = _generation.load(std::memory_order_acquire);
+        accessor->second.bytes = bytes;
+        accessor->second.referenced.store(false, std::memory_order_relaxed);
+        accessor->second.hits.store(0, std::memory_order_relaxed);
+    }
+    _inserts.fetch_add(1, std::memory_order_relaxed);
+
+    // The accessor must be released before taking the clock lock since eviction takes them in the opposite order
+    if (clockKey)
+    {
+        std::lock_guard<std::mutex> lock(_clockMutex);
+        _clock.push_back(std::move(clockKey));
+
+        const size_t staleKeys = _staleClockKeys.load(std::memory_order_relaxed);
+        if (staleKeys >= kMinStaleClockKeys && staleKeys > _clock.size() / 2)
+        {
+            _CompactClock();
+        }
+    }
+
+    const size_t budget = _GetBudget();
+    if (budget != 0 && _footprint.load(std::memory_order_relaxed) > budget)
+    {
+        _Evict(budget);
+    }
+}
+
+bool OmniUsdResolverCache::Remove(std::string_view key)
+{
+    std::string buffer;
+    key = cache_key::Canonicalize(key, buffer);
+
+    // The key stays in the clock until eviction or compaction finds that it is stale
     Cache::accessor accessor;
-    if (_cache.insert(accessor, key))
+    if (!_cache.find(accessor, key))
     {
-        accessor->second = entry;
+        return false;
     }
+
+    _footprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+    _entries.fetch_sub(1, std::memory_order_relaxed);
+    _removes.fetch_add(1, std::memory_order_relaxed);
+    _staleClockKeys.fetch_add(1, std::memory_order_relaxed);
+    return _cache.erase(accessor);
 }
 
-bool OmniUsdResolverCache::Remove(const std::string& key)
+void OmniUsdResolverCache::Clear()
 {
-    return _cache.erase(key);
+    // tbb::concurrent_hash_map::clear is not safe to call concurrently with other operations
+    // so entries are invalidated by bumping the generation instead
+    const uint64_t generation = _generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    // The invalidated entries are then erased through the clock so they no longer count against the budget or in
+    // the stats. Entries added since the generation was bumped are kept
+    {
+        std::lock_guard<std::mutex> lock(_clockMutex);
+        std::deque<ClockKey> live;
+        size_t staleKeys = 0;
+        for (auto& key : _clock)
+        {
+            Cache::accessor accessor;
+            if (!_cache.find(accessor, *key) || accessor->second.key != key)
+            {
+                ++staleKeys;
+                continue;
+            }
+
+            if (accessor->second.generation == generation)
+            {
+                live.push_back(std::move(key));
+                continue;
+            }
+
+            _footprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+            _entries.fetch_sub(1, std::memory_order_relaxed);
+            _cache.erase(accessor);
+        }
+        _staleClockKeys.fetch_sub(staleKeys, std::memory_order_relaxed);
+        _clock = std::move(live);
+    }
+
+    ClearIdentifiers();
+}
+
+bool OmniUsdResolverCache::GetIdentifier(std::string_view anchor,
+                                         std::string_view assetPath,
+                                         std::string& identifier) const
+{
+    IdentifierCache::const_accessor accessor;
+    if (_identifiers.find(accessor, IdentifierKey{ anchor, assetPath }) &&
+        accessor->second.generation == _identifierGeneration.load(std::memory_order_acquire))
+    {
+        identifier = accessor->second.identifier;
+        return true;
+    }
+
+    return false;
+}
+
+void OmniUsdResolverCache::AddIdentifier(std::string_view anchor,
+                                         std::string_view assetPath,
+                                         const std::string& identifier,
+                                         bool isSearchPath)
+{
+    // Same estimate as resolved entries: the owned key plus the identifier plus the node overhead
+    constexpr size_t kOverhead = 128;
+    const size_t bytes = kOverhead + anchor.size() + assetPath.size() + identifier.size();
+
+    std::shared_ptr<const std::string> slotKey;
+    {
+        IdentifierCache::accessor accessor;
+        if (_identifiers.find(accessor, IdentifierKey{ anchor, assetPath }))
+        {
+            if (accessor->second.generation == _identifierGeneration.load(std::memory_order_acquire))
+            {
+                return;
+            }
+        }
+        else
+        {
+            const size_t budget = _GetBudget();
+            if (budget != 0 && _identifierFootprint.load(std::memory_order_relaxed) + bytes > budget / 4)
+            {
+                return;
+            }
+
+            auto ownedKey = std::make_shared<std::string>();
+            ownedKey->reserve(anchor.size() + assetPath.size());
+            ownedKey->append(anchor).append(assetPath);
+            const std::string_view ownedView(*ownedKey);
+
+            if (_identifiers.insert(
+                    accessor, IdentifierKey{ ownedView.substr(0, anchor.size()), ownedView.substr(anchor.size()) }))
+            {
+                // The inserted key is a view of ownedKey so it has to live as long as the entry
+                accessor->second.key = ownedKey;
+                slotKey = std::move(ownedKey);
+            }
+            else if (accessor->second.generation == _identifierGeneration.load(std::memory_order_acquire))
+            {
+                // Another thread memoized it first
+                return;
+            }
+        }
+
+        _identifierFootprint.fetch_add(bytes, std::memory_order_relaxed);
+        _identifierFootprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+        accessor->second.identifier = identifier;
+        accessor->second.generation = _identifierGeneration.load(std::memory_order_acquire);
+        accessor->second.bytes = bytes;
+    }
+
+    // The accessor must be released before taking the slots lock since dropping identifiers takes them in the
+    // opposite order
+    if (slotKey)
+    {
+        const size_t anchorDir = anchor.find_last_of("/\\");
+        const size_t anchorDirSize = anchorDir == std::string_view::npos ? 0 : anchorDir + 1;
+
+        std::lock_guard<std::mutex> lock(_identifierSlotsMutex);
+        _identifierSlots.push_back(IdentifierSlot{ std::move(slotKey), anchor.size(), anchorDirSize, isSearchPath });
+    }
+}
+
+void OmniUsdResolverCache::InvalidateIdentifiers(std::string_view url)
+{
+    std::lock_guard<std::mutex> lock(_identifierSlotsMutex);
+    auto it = std::remove_if(_identifierSlots.begin(), _identifierSlots.end(),
+                             [this, url](const IdentifierSlot& slot)
+                             {
+                                 if (!slot.isSearchPath || slot.anchorDirSize == 0 ||
+                                     url.compare(0, slot.anchorDirSize,
+                                                 std::string_view(*slot.key).substr(0, slot.anchorDirSize)) != 0)
+                                 {
+                                     return false;
+                                 }
+
+                                 TF_DEBUG(OMNI_USD_RESOLVER)
+                                     .Msg("%s: %s invalidated by %.*s\n", TF_FUNC_NAME().c_str(),
+                                          slot.key->c_str() + slot.anchorSize, static_cast<int>(url.size()),
+                                          url.data());
+                                 return _EraseIdentifier(slot, false);
+                             });
+    _identifierSlots.erase(it, _identifierSlots.end());
+}
+
+void OmniUsdResolverCache::ClearIdentifiers()
+{
+    _identifierGeneration.fetch_add(1, std::memory_order_acq_rel);
+
+    // Invalidated identifiers would otherwise keep counting against the budget until their pair comes up again
+    std::lock_guard<std::mutex> lock(_identifierSlotsMutex);
+    auto it = std::remove_if(_identifierSlots.begin(), _identifierSlots.end(),
+                             [this](const IdentifierSlot& slot) { return _EraseIdentifier(slot, true); });
+    _identifierSlots.erase(it, _identifierSlots.end());
+}
+
+// Erases the identifier tracked by slot. Identifiers that are still valid are kept when onlyInvalidated is set.
+// Returns whether the slot can be dropped
+bool OmniUsdResolverCache::_EraseIdentifier(const IdentifierSlot& slot, bool onlyInvalidated)
+{
+    const std::string_view key(*slot.key);
+    IdentifierCache::accessor accessor;
+    if (!_identifiers.find(accessor, IdentifierKey{ key.substr(0, slot.anchorSize), key.substr(slot.anchorSize) }) ||
+        accessor->second.key != slot.key)
+    {
+        return true;
+    }
+
+    if (onlyInvalidated && accessor->second.generation == _identifierGeneration.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // The slot keeps the key alive, which the accessor still refers to while erasing
+    _identifierFootprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+    _identifiers.erase(accessor);
+    return true;
+}
+
+bool OmniUsdResolverCache::_IsValid(const CachedEntry& cachedEntry) const
+{
+    if (cachedEntry.generation != _generation.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    return cachedEntry.expires == Clock::time_point::max() || Clock::now() < cachedEntry.expires;
+}
+
+void OmniUsdResolverCache::SetBudget(size_t bytes)
+{
+    _budget.store(bytes, std::memory_order_relaxed);
+
+    if (bytes != 0 && bytes != kDefaultBudget && _footprint.load(std::memory_order_relaxed) > bytes)
+    {
+        _Evict(bytes);
+    }
+}
+
+size_t OmniUsdResolverCache::GetFootprint() const
+{
+    return _footprint.load(std::memory_order_relaxed);
+}
+
+OmniUsdResolverCache::Stats OmniUsdResolverCache::GetStats() const
+{
+    Stats stats;
+    stats.hits = _hits.load(std::memory_order_relaxed);
+    stats.misses = _misses.load(std::memory_order_relaxed);
+    stats.inserts = _inserts.load(std::memory_order_relaxed);
+    stats.removes = _removes.load(std::memory_order_relaxed);
+    stats.evictions = _evictions.load(std::memory_order_relaxed);
+    stats.entries = _entries.load(std::memory_order_relaxed);
+    stats.bytes = _footprint.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<std::pair<std::string, uint64_t>> OmniUsdResolverCache::GetHottestKeys(size_t count) const
+{
+    std::vector<std::pair<std::string, uint64_t>> keys;
+
+    // Traversing a tbb::concurrent_hash_map is not safe while other threads insert or erase, so the
+    // clock is used to enumerate the keys instead
+    std::lock_guard<std::mutex> lock(_clockMutex);
+    for (const auto& key : _clock)
+    {
+        Cache::const_accessor accessor;
+        if (_cache.find(accessor, *key) && accessor->second.key == key && _IsValid(accessor->second))
+        {
+            keys.emplace_back(*key, accessor->second.hits.load(std::memory_order_relaxed));
+        }
+    }
+
+    count = std::min(count, keys.size());
+    std::partial_sort(keys.begin(), keys.begin() + count, keys.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+    keys.resize(count);
+    return keys;
+}
+
+size_t OmniUsdResolverCache::_GetBudget() const
+{
+    const size_t budget = _budget.load(std::memory_order_relaxed);
+    return budget == kDefaultBudget ? GetDefaultBudget() : budget;
+}
+
+void OmniUsdResolverCache::_Evict(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(_clockMutex);
+
+    // Every entry gets at most one second chance per pass, so two passes over the clock is enough to either
+    // get under budget or run out of entries
+    for (size_t visits = 2 * _clock.size(); visits > 0 && !_clock.empty(); --visits)
+    {
+        if (_footprint.load(std::memory_order_relaxed) <= budget)
+        {
+            break;
+        }
+
+        ClockKey key = std::move(_clock.front());
+        _clock.pop_front();
+
+        Cache::accessor accessor;
+        if (!_cache.find(accessor, *key) || accessor->second.key != key)
+        {
+            // The entry was already removed
+            _staleClockKeys.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (_IsValid(accessor->second) && accessor->second.referenced.exchange(false, std::memory_order_relaxed))
+        {
+            _clock.push_back(std::move(key));
+            continue;
+        }
+
+        _footprint.fetch_sub(accessor->second.bytes, std::memory_order_relaxed);
+        _entries.fetch_sub(1, std::memory_order_relaxed);
+        _evictions.fetch_add(1, std::memory_order_relaxed);
+        _cache.erase(accessor);
+    }
+}
+
+void OmniUsdResolverCache::_CompactClock()
+{
+    // _clockMutex is held by the caller
+    std::deque<ClockKey> live;
+    for (auto& key : _clock)
+    {
+        Cache::const_accessor accessor;
+        if (_cache.find(accessor, *key) && accessor->second.key == key)
+        {
+            live.push_back(std::move(key));
+        }
+    }
+    _staleClockKeys.fetch_sub(_clock.size() - live.size(), std::memory_order_relaxed);
+    _clock = std::move(live);
 }
@@ -12,10 +12,26 @@
 
 #include "UsdIncludes.h"
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 /// \brief A simple thread-safe cache used by the Omniverse Usd Resolver
+///
+/// Keys are canonicalized (see CacheKey.h) so that equivalent spellings of the same URL share one entry.
+/// When a byte budget is set entries are evicted using the CLOCK (second chance) policy. Readers only mark
+/// entries as referenced, so lookups never wait on eviction.
+///
+/// The cache also memoizes the identifiers created for an (anchor, assetPath) pair. They are invalidated together
+/// with the resolved entries, since an identifier for a search path depends on what resolved next to the anchor.
+/// Writing an asset only invalidates the search path identifiers anchored in a directory that contains it.
 class OmniUsdResolverCache
 {
 public:
@@ -27,31 +43,205 @@ public:
         std::string resolvedPath;
         std::string version;
         std::chrono::system_clock::time_point modifiedTime;
-        uint64_t size;
+        uint64_t size = 0;
     };
 
+    /// \brief Entries are immutable once cached and shared between the cache and anyone that looked them up,
+    /// so a cache hit only needs to bump a reference count
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    using Clock = std::chrono::steady_clock;
+
+    /// \brief Counters describing how effective the cache is
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t removes = 0;
+        uint64_t evictions = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+    };
+
+    /// \brief Used as the byte budget to follow the default set with SetDefaultBudget
+    static constexpr size_t kDefaultBudget = SIZE_MAX;
+
     OmniUsdResolverCache() = default;
 
+    /// \brief Sets the byte budget used by every cache that has not been given its own budget.
+    /// The initial default comes from OMNI_USD_RESOLVER_CACHE_BUDGET. Zero means the caches are unbounded
+    static void SetDefaultBudget(size_t bytes);
+
+    /// \brief Returns the byte budget used by every cache that has not been given its own budget
+    static size_t GetDefaultBudget();
+
     /// \brief Finds the entry in the cache located at \p key
     /// \param key the key to the entry in the cache
-    /// \param[out] entry the data entry stored in the cache
-    /// \returns true if the entry was found. Otherwise, false
-    bool Get(const std::string& key, Entry& entry) const;
+    /// \returns the entry if it was found and has not expired. Otherwise, nullptr
+    EntryPtr Get(std::string_view key) const;
 
     /// \brief Adds an entry to the cache located at \p key if not present
     /// \param key the key to the entry that is being cached
-    /// \param[out] entry the data entry that will be added to the cache
-    void Add(const std::string& key, const Entry& entry);
+    /// \param entry the data entry that will be added to the cache
+    /// \param ttl how long the entry is valid for. A zero duration means the entry never expires
+    void Add(std::string_view key, EntryPtr entry, Clock::duration ttl = Clock::duration::zero());
     /// \brief Removes the entry in the cache located at \p key
     /// \param key the key to the entry that will be removed from the cache
     /// \returns true if the entry was removed. Otherwise, false
-    bool Remove(const std::string& key);
+    bool Remove(std::string_view key);
+
+    /// \brief Invalidates all entries in the cache
+    ///
+    /// Unlike Remove this is safe to call while other threads are reading from or adding to the cache.
+    /// Invalidated entries are erased and no longer count in the footprint or stats.
+    void Clear();
+
+    /// \brief Sets the approximate number of bytes this cache may use before entries are evicted
+    /// \param bytes the byte budget. Zero means unbounded and kDefaultBudget follows SetDefaultBudget
+    void SetBudget(size_t bytes);
+
+    /// \brief Returns the approximate number of bytes used by the entries in the cache
+    size_t GetFootprint() const;
+
+    /// \brief Returns a snapshot of the cache counters
+    Stats GetStats() const;
+
+    /// \brief Returns up to \p count keys with the most hits, ordered from most to least hits
+    std::vector<std::pair<std::string, uint64_t>> GetHottestKeys(size_t count) const;
+
+    /// \brief Finds the identifier previously created for \p assetPath anchored to \p anchor
+    /// \param anchor the resolved path of the anchoring asset
+    /// \param assetPath the asset path that was anchored
+    /// \param identifier set to the memoized identifier if one was found
+    /// \returns true if a memoized identifier was found. Otherwise, false
+    bool GetIdentifier(std::string_view anchor, std::string_view assetPath, std::string& identifier) const;
+
+    /// \brief Memoizes the identifier created for \p assetPath anchored to \p anchor
+    ///
+    /// Identifiers share the byte budget of the cache. Once they use a quarter of it identifiers for new pairs
+    /// are no longer memoized. Invalidated identifiers are dropped and no longer count against it.
+    /// \param isSearchPath whether \p assetPath is a search path, whose identifier depends on what exists next to
+    /// \p anchor
+    void AddIdentifier(std::string_view anchor,
+                       std::string_view assetPath,
+                       const std::string& identifier,
+                       bool isSearchPath);
+
+    /// \brief Drops the memoized search path identifiers anchored in a directory that contains \p url
+    /// \note This should be called whenever an asset is written so that a newly created asset is found
+    void InvalidateIdentifiers(std::string_view url);
+
+    /// \brief Invalidates all memoized identifiers but leaves the resolved entries untouched
+    void ClearIdentifiers();
 
 private:
+    struct CachedEntry
+    {
+        // The key in the hash map is a view of this string. It is owned here so that looking up
+        // an entry with a std::string_view does not need to allocate a std::string. The clock shares it
+        std::shared_ptr<const std::string> key;
+        EntryPtr entry;
+        Clock::time_point expires;
+        uint64_t generation;
+        size_t bytes = 0;
+
+        // Set by readers so that eviction gives the entry a second chance. Readers only hold a
+        // const_accessor so this needs to be atomic
+        mutable std::atomic<bool> referenced{ false };
+
+        mutable std::atomic<uint64_t> hits{ 0 };
+    };
+
+    struct KeyHashCompare
+    {
+        static size_t hash(std::string_view key)
+        {
+            return std::hash<std::string_view>()(key);
+        }
+        static bool equal(std::string_view a, std::string_view b)
+        {
+            return a == b;
+        }
+    };
+
+    struct IdentifierKey
+    {
+        std::string_view anchor;
+        std::string_view assetPath;
+    };
+
+    struct CachedIdentifier
+    {
+        // The key in the hash map holds views of this string, which is the anchor followed by the asset path.
+        // The identifier slot shares it
+        std::shared_ptr<const std::string> key;
+        std::string identifier;
+        uint64_t generation;
+        size_t bytes = 0;
+    };
+
+    struct IdentifierKeyHashCompare
+    {
+        static size_t hash(const IdentifierKey& key)
+        {
+            const size_t h = std::hash<std::string_view>()(key.anchor);
+            return h ^ (std::hash<std::string_view>()(key.assetPath) + 0x9e3779b9 + (h << 6) + (h >> 2));
+        }
+        static bool equal(const IdentifierKey& a, const IdentifierKey& b)
+        {
+            return a.anchor == b.anchor && a.assetPath == b.assetPath;
+        }
+    };
+
+    using ClockKey = std::shared_ptr<const std::string>;
+
+    // Tracks a memoized identifier so it can be dropped without iterating the hash map, which is not safe to do
+    // concurrently with other operations
+    struct IdentifierSlot
+    {
+        std::shared_ptr<const std::string> key;
+        size_t anchorSize;
+        size_t anchorDirSize;
+        bool isSearchPath;
+    };
+
+    bool _IsValid(const CachedEntry& cachedEntry) const;
+    size_t _GetBudget() const;
+    void _Evict(size_t budget);
+    void _CompactClock();
+    bool _EraseIdentifier(const IdentifierSlot& slot, bool onlyInvalidated);
+
     // XXX: If we want to get rid of the direct tbb dependency we could put this
     // behind an Impl
-    using Cache = tbb::concurrent_hash_map<std::string, OmniUsdResolverCache::Entry>;
+    using Cache = tbb::concurrent_hash_map<std::string_view, CachedEntry, KeyHashCompare>;
     Cache _cache;
+    std::atomic<uint64_t> _generation{ 0 };
+
+    using IdentifierCache = tbb::concurrent_hash_map<IdentifierKey, CachedIdentifier, IdentifierKeyHashCompare>;
+    IdentifierCache _identifiers;
+    std::atomic<uint64_t> _identifierGeneration{ 0 };
+    std::atomic<size_t> _identifierFootprint{ 0 };
+    std::mutex _identifierSlotsMutex;
+    std::vector<IdentifierSlot> _identifierSlots;
+
+    std::atomic<size_t> _budget{ kDefaultBudget };
+    std::atomic<size_t> _footprint{ 0 };
+
+    mutable std::atomic<uint64_t> _hits{ 0 };
+    mutable std::atomic<uint64_t> _misses{ 0 };
+    std::atomic<uint64_t> _inserts{ 0 };
+    std::atomic<uint64_t> _removes{ 0 };
+    std::atomic<uint64_t> _evictions{ 0 };
+    std::atomic<uint64_t> _entries{ 0 };
+
+    // CLOCK eviction: keys are visited in insertion order and entries that were read since the last
+    // visit are moved to the back instead of being evicted. Only writers take this lock.
+    // A key in the clock is only live while it is the key of its entry in the hash map. Keys of removed entries,
+    // including entries that were added again since, stay in the clock until eviction or compaction drops them
+    mutable std::mutex _clockMutex;
+    std::deque<ClockKey> _clock;
+    std::atomic<size_t> _staleClockKeys{ 0 };
 };
 
 typedef PXR_NS::ArThreadLocalScopedCache<OmniUsdResolverCache> OmniUsdResolverScopedCache;
@@ -10,8 +10,33 @@
 
 #include "OmniUsdResolverContext_Ar2.h"
 
-OmniUsdResolverContext::OmniUsdResolverContext(std::string assetPath) : _assetPath(std::move(assetPath))
+#include "ContextPartition.h"
+#include "utils/OmniClientUtils.h"
+
+#include <tuple>
+
+OmniUsdResolverContext::OmniUsdResolverContext(std::string assetPath, std::vector<std::string> searchPaths)
+    : _assetPath(std::move(assetPath)), _searchPaths(std::move(searchPaths))
 {
+    if (_searchPaths.empty())
+    {
+        return;
+    }
+
+    // The directory of the asset is searched first, the same way a bound context is used without search paths
+    std::vector<std::string> searchRoots;
+    searchRoots.reserve(_searchPaths.size() + 1);
+    if (!_assetPath.empty())
+    {
+        static const std::string kDot{ "." };
+        searchRoots.push_back(makeString(omniClientCombineUrls, _assetPath.c_str(), kDot.c_str()));
+    }
+    for (const auto& searchPath : _searchPaths)
+    {
+        searchRoots.push_back(normalizeUrl(searchPath));
+    }
+
+    _partition = std::make_shared<ContextPartition>(std::move(searchRoots));
 }
 
 const std::string& OmniUsdResolverContext::GetAssetPath() const
@@ -19,17 +44,27 @@ const std::string& OmniUsdResolverContext::GetAssetPath() const
     return _assetPath;
 }
 
+const std::vector<std::string>& OmniUsdResolverContext::GetSearchPaths() const
+{
+    return _searchPaths;
+}
+
+const std::shared_ptr<ContextPartition>& OmniUsdResolverContext::GetPartition() const
+{
+    return _partition;
+}
+
 bool OmniUsdResolverContext::operator<(const OmniUsdResolverContext& rhs) const
 {
-    return _assetPath < rhs._assetPath;
+    return std::tie(_assetPath, _searchPaths) < std::tie(rhs._assetPath, rhs._searchPaths);
 }
 
 bool OmniUsdResolverContext::operator==(const OmniUsdResolverContext& rhs) const
 {
-    return _assetPath == rhs._assetPath;
+    return _assetPath == rhs._assetPath && _searchPaths == rhs._searchPaths;
 }
 
 size_t hash_value(const OmniUsdResolverContext& ctx)
 {
-    return TfHash()(ctx._assetPath);
+    return TfHash::Combine(ctx._assetPath, ctx._searchPaths);
 }
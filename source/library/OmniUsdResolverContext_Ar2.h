@@ -12,17 +12,32 @@
 
 #include "UsdIncludes.h"
 
-/// \brief The Omniverse Usd ResolverContext. A very bare-bones implementation
-/// which just stores the assetPath
+#include <memory>
+#include <string>
+#include <vector>
+
+class ContextPartition;
+
+/// \brief The Omniverse Usd ResolverContext. Stores the assetPath the context was created for and,
+/// optionally, an ordered list of search paths
+///
+/// A context with search paths owns a ContextPartition that caches how search paths resolve in it. Copies of
+/// a context share the same partition.
 class OmniUsdResolverContext
 {
 public:
     OmniUsdResolverContext() = default;
-    explicit OmniUsdResolverContext(std::string assetPath);
+    explicit OmniUsdResolverContext(std::string assetPath, std::vector<std::string> searchPaths = {});
 
     /// Returns the assetPath that the context is currently bound to
     const std::string& GetAssetPath() const;
 
+    /// Returns the search paths of the context, in the order they are searched
+    const std::vector<std::string>& GetSearchPaths() const;
+
+    /// Returns the partition owned by the context, or nullptr if the context does not have search paths
+    const std::shared_ptr<ContextPartition>& GetPartition() const;
+
     bool operator<(const OmniUsdResolverContext& rhs) const;
     bool operator==(const OmniUsdResolverContext& rhs) const;
 
@@ -30,6 +45,8 @@ public:
 
 private:
     std::string _assetPath;
+    std::vector<std::string> _searchPaths;
+    std::shared_ptr<ContextPartition> _partition;
 };
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -10,13 +10,23 @@
 
 #include "OmniUsdResolver_Ar2.h"
 
+#include "CacheKey.h"
+#include "ContextPartition.h"
+#include "ContextStack.h"
 #include "DebugCodes.h"
+#include "GlobalCache.h"
 #include "MdlHelper.h"
 #include "Notifications.h"
 #include "OmniUsdAsset.h"
+#include "OmniUsdPackage.h"
+#include "OmniUsdResolver.h"
 #include "OmniUsdResolverContext_Ar2.h"
+#include "OmniUsdStreamingAsset.h"
 #include "OmniUsdWritableAsset.h"
+#include "Prefetch.h"
+#include "ResolveIndex.h"
 #include "ResolverHelper.h"
+#include "SearchPathCache.h"
 #include "UsdIncludes.h"
 #include "utils/OmniClientUtils.h"
 #include "utils/PathUtils.h"
@@ -26,8 +36,11 @@
 
 #include <cctype>
 #include <algorithm>
+#include <unordered_map>
+#include <pxr/base/js/json.h>
 #include <pxr/usd/ar/filesystemAsset.h>
 #include <pxr/usd/ar/filesystemWritableAsset.h>
+#include <pxr/usd/ar/packageUtils.h>
 
 #include <OmniClient.h>
 
@@ -35,11 +48,17 @@ PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace
 {
-inline bool _IsSearchPath(const std::string& assetPath)
+inline bool _IsSearchPath(std::string_view assetPath)
 {
     return isRelativePath(assetPath) && !isFileRelative(assetPath);
 }
 
+std::string_view _StripFormatArgs(const std::string& identifier)
+{
+    static constexpr std::string_view kSdfFormatArgs{ ":SDF_FORMAT_ARGS:" };
+    return std::string_view(identifier).substr(0, identifier.find(kSdfFormatArgs));
+}
+
 std::string _StrToLower(std::string s)
 {
     std::transform(
@@ -54,10 +73,15 @@ AR_DEFINE_RESOLVER(OmniUsdResolver, ArResolver);
 
 OmniUsdResolver::OmniUsdResolver()
 {
+    // The resolver is only created once Ar is first used, so indexing starts then rather than when the
+    // library is loaded
+    mdl_helper::IndexSearchRootsFromEnv();
 }
 
 OmniUsdResolver::~OmniUsdResolver()
 {
+    // Persist anything resolved by this process so the next one can start warm
+    resolve_index::Save();
 }
 
 std::string OmniUsdResolver::_CreateIdentifier(const std::string& assetPath, const ArResolvedPath& anchorAssetPath) const
@@ -70,7 +94,7 @@ std::string OmniUsdResolver::_CreateIdentifier(const std::string& assetPath, con
     }
 
     std::string assetIdentifier;
-    if (anchorAssetPath.empty() || isRelativePath(anchorAssetPath))
+    if (anchorAssetPath.empty() || isRelativePath(anchorAssetPath.GetPathString()))
     {
         TF_DEBUG(OMNI_USD_RESOLVER)
             .Msg("%s: %s anchorAssetPath\n", TF_FUNC_NAME().c_str(), anchorAssetPath.empty() ? "empty" : "relative");
@@ -100,10 +124,22 @@ std::string OmniUsdResolver::_CreateIdentifier(const std::string& assetPath, con
     }
     else
     {
-        auto anchoredAssetPath =
-            makeString(omniClientCombineUrls, anchorAssetPath.GetPathString().c_str(), assetPath.c_str());
+        // The same (anchor, assetPath) pairs come up over and over during composition and recomposition, so
+        // identifiers are memoized alongside the resolves they were created for
+        const std::string& anchor = anchorAssetPath.GetPathString();
+        auto cache = m_threadCache.GetCurrentCache();
+        if ((cache && cache->GetIdentifier(anchor, assetPath, assetIdentifier)) ||
+            global_cache::GetIdentifier(anchor, assetPath, assetIdentifier))
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER)
+                .Msg("%s: %s -> %s (memoized)\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), assetIdentifier.c_str());
+            return assetIdentifier;
+        }
 
-        if (_IsSearchPath(assetPath) && Resolve(anchoredAssetPath).empty())
+        auto anchoredAssetPath = makeString(omniClientCombineUrls, anchor.c_str(), assetPath.c_str());
+
+        const bool isSearchPath = _IsSearchPath(assetPath);
+        if (isSearchPath && !_ResolvesNextToAnchor(assetPath, anchorAssetPath, anchoredAssetPath))
         {
             // Any other non-MDL search paths should use the "look here first" strategy, meaning that
             // we first try to resolve the anchored asset path. If the anchored asset path does not resolve
@@ -116,12 +152,51 @@ std::string OmniUsdResolver::_CreateIdentifier(const std::string& assetPath, con
         {
             assetIdentifier = std::move(anchoredAssetPath);
         }
+
+        if (cache)
+        {
+            cache->AddIdentifier(anchor, assetPath, assetIdentifier, isSearchPath);
+        }
+
+        // Identifiers for search paths depend on what exists next to the anchor, which the global cache has no
+        // way to expire, so only the pure URL work is memoized there
+        if (!isSearchPath)
+        {
+            global_cache::AddIdentifier(anchor, assetPath, assetIdentifier);
+        }
     }
 
     TF_DEBUG(OMNI_USD_RESOLVER).Msg("%s: %s -> %s\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), assetIdentifier.c_str());
     return assetIdentifier;
 }
 
+bool OmniUsdResolver::_ResolvesNextToAnchor(const std::string& assetPath,
+                                            const ArResolvedPath& anchorAssetPath,
+                                            const std::string& anchoredAssetPath) const
+{
+    if (!search_path_cache::IsEnabled())
+    {
+        return !Resolve(anchoredAssetPath).empty();
+    }
+
+    static const std::string kDot{ "." };
+    const std::string anchorDir = makeString(omniClientCombineUrls, anchorAssetPath.GetPathString().c_str(), kDot.c_str());
+    if (search_path_cache::IsMissing(anchorDir, assetPath))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER)
+            .Msg("%s: %s is a known miss in %s\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), anchorDir.c_str());
+        return false;
+    }
+
+    if (Resolve(anchoredAssetPath).empty())
+    {
+        search_path_cache::AddMissing(anchorDir, assetPath);
+        return false;
+    }
+
+    return true;
+}
+
 std::string OmniUsdResolver::_CreateIdentifierForNewAsset(const std::string& assetPath,
                                                           const ArResolvedPath& anchorAssetPath) const
 {
@@ -137,11 +212,11 @@ std::string OmniUsdResolver::_CreateIdentifierForNewAsset(const std::string& ass
 
         // If we have a relative path that we need to create a new asset for
         // a normalized anchor asset path is also required. An empty anchor asset path
-        // will be expanded to whatever base URL is set in client-library (omniClientPushBaseURL).
+        // will be expanded to the bound context, or whatever base URL is set in client-library (omniClientPushBaseURL).
         // In most cases this will be the current working directory but using the base URL from
         // client-library instead of getcwd() gives us the benefit of URL support
         const std::string anchor = anchorAssetPath.empty() || isRelativePath(anchorAssetPath.GetPathString()) ?
-                                       makeString(omniClientCombineWithBaseUrl, kDot.c_str()) :
+                                       context_stack::CombineWithAnchor(kDot) :
                                        anchorAssetPath.GetPathString();
 
         // When creating an identifier for a new asset, i.e SdfLayer::CreateNew, we want to use the same
@@ -157,19 +232,118 @@ std::string OmniUsdResolver::_CreateIdentifierForNewAsset(const std::string& ass
     return identifier;
 }
 
-OmniUsdResolverCache::Entry OmniUsdResolver::_ResolveThroughCache(const std::string& identifier) const
+OmniUsdResolverCache::EntryPtr OmniUsdResolver::_ResolveThroughCache(const std::string& identifier) const
 {
-    static constexpr std::string_view kSdfFormatArgs{ ":SDF_FORMAT_ARGS:" };
-    const std::string identifierStripped = identifier.substr(0, identifier.find(kSdfFormatArgs));
-
-    OmniUsdResolverCache::Entry cacheEntry;
+    // Cache hits should not allocate, so the stripped identifier is only copied into a std::string on a miss
+    const std::string_view identifierView = _StripFormatArgs(identifier);
+
+    // Search paths are looked up in the partition of the bound context when it has search paths of its own.
+    // A scoped cache can be shared by several contexts, so it is keyed on the bare search path and cannot hold
+    // what a search path resolved to in one partition. The partition has a cache of its own for that
+    ContextPartition* partition = nullptr;
+    if (_IsSearchPath(identifierView))
+    {
+        const OmniUsdResolverContext* context = context_stack::GetContext();
+        partition = context ? context->GetPartition().get() : nullptr;
+    }
 
     auto cache = m_threadCache.GetCurrentCache();
-    if (!cache || !cache->Get(identifierStripped, cacheEntry))
+    if (cache && !partition)
+    {
+        if (auto cacheEntry = cache->Get(identifierView))
+        {
+            return cacheEntry;
+        }
+    }
+
+    const std::string identifierStripped(identifierView);
+
+    if (partition)
+    {
+        if (auto cacheEntry = _ResolveInPartition(*partition, identifierStripped))
+        {
+            return cacheEntry;
+        }
+    }
+
+    // What an MDL builtin resolves to does not change for the life of the process, so they are only resolved once.
+    // Modules found by the background indexer are already resolved. This comes after the partition lookup so that
+    // a context with search paths of its own still resolves builtins through them
+    if (auto cacheEntry = mdl_helper::GetResolvedBuiltin(identifierStripped))
+    {
+        if (cache)
+        {
+            cache->Add(identifierStripped, cacheEntry);
+        }
+        return cacheEntry;
+    }
+
+    // When composing in parallel many threads can miss the cache for the same identifier at the same time.
+    // Only the first one resolves it, the others wait for its result. The result is added to the caches before
+    // the in-flight resolve is forgotten so that threads arriving afterwards find it in the cache
+    std::string canonicalBuffer;
+    const std::string_view canonicalKey = cache_key::Canonicalize(identifierStripped, canonicalBuffer);
+
+    // Relative identifiers resolve against the context bound on the calling thread, so only threads with the
+    // same anchor can share a resolve
+    std::string inflightKey(canonicalKey);
+    const std::string* anchor = context_stack::GetAnchor();
+    if (anchor && isRelativePath(identifierStripped))
+    {
+        inflightKey = *anchor + '\0' + inflightKey;
+    }
+
+    // The global cache is shared by every context in the process, so it only holds identifiers that resolve the
+    // same way regardless of the context bound on the calling thread
+    const bool isAbsolute = !isRelativePath(identifierStripped);
+
+    bool shared = false;
+    auto cacheEntry = m_inflightResolves.Do(
+        std::move(inflightKey),
+        [&]()
+        {
+            // The global cache sits behind the scoped cache. Only successful resolves are stored in the global cache
+            // since there is no good way to determine when a failed resolve should be invalidated. The scoped cache
+            // will still hold on to failed resolves as the lifetime of the scope is controlled by the caller.
+            auto entry = isAbsolute ? global_cache::Get(identifierStripped) : nullptr;
+            if (!entry && (entry = resolve_index::Get(identifierStripped)) && isAbsolute)
+            {
+                global_cache::Add(identifierStripped, entry);
+            }
+            if (!entry)
+            {
+                auto resolved = std::make_shared<OmniUsdResolverCache::Entry>();
+                resolved->identifier = identifierStripped;
+                resolved->resolvedPath = ResolverHelper::Resolve(
+                    identifierStripped, resolved->url, resolved->version, resolved->modifiedTime, resolved->size);
+                entry = std::move(resolved);
+
+                if (!entry->resolvedPath.empty())
+                {
+                    if (isAbsolute)
+                    {
+                        global_cache::Add(identifierStripped, entry);
+                    }
+                    resolve_index::Add(identifierStripped, entry);
+                    mdl_helper::SetResolvedBuiltin(identifierStripped, entry);
+                }
+            }
+
+            if (cache)
+            {
+                cache->Add(identifierStripped, entry);
+            }
+
+            return entry;
+        },
+        &shared);
+
+    if (shared)
     {
-        cacheEntry.resolvedPath = ResolverHelper::Resolve(
-            identifierStripped, cacheEntry.url, cacheEntry.version, cacheEntry.modifiedTime, cacheEntry.size);
+        TF_DEBUG(OMNI_USD_RESOLVER)
+            .Msg("%s: shared in-flight resolve of %s\n", TF_FUNC_NAME().c_str(), identifierStripped.c_str());
 
+        // The thread that resolved the identifier may have been bound to a different scoped cache
         if (cache)
         {
             cache->Add(identifierStripped, cacheEntry);
@@ -179,14 +353,153 @@ OmniUsdResolverCache::Entry OmniUsdResolver::_ResolveThroughCache(const std::str
     return cacheEntry;
 }
 
+OmniUsdResolverCache::EntryPtr OmniUsdResolver::_ResolveInPartition(ContextPartition& partition,
+                                                                    const std::string& assetPath) const
+{
+    OmniUsdResolverCache& cache = partition.GetCache();
+    if (auto cacheEntry = cache.Get(assetPath))
+    {
+        return cacheEntry;
+    }
+
+    // The listings of the search roots rule out most of them, so usually only the root that holds the asset is
+    // resolved. Roots that could not be listed are probed in order
+    for (const auto& candidate : partition.FindCandidates(assetPath))
+    {
+        auto cacheEntry = _ResolveThroughCache(candidate);
+        if (!cacheEntry->resolvedPath.empty())
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT)
+                .Msg("%s: %s found at %s\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), candidate.c_str());
+
+            // An asset added under an earlier root by another process shadows this one once the listings expire
+            const auto ttl = ContextPartition::GetTtl(candidate);
+            if (ttl != OmniUsdResolverCache::Clock::duration::zero())
+            {
+                cache.Add(assetPath, cacheEntry, ttl);
+            }
+            return cacheEntry;
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<OmniUsdResolverCache::EntryPtr> OmniUsdResolver::ResolveBatch(const std::vector<std::string>& identifiers) const
+{
+    std::vector<OmniUsdResolverCache::EntryPtr> results(identifiers.size());
+
+    auto cache = m_threadCache.GetCurrentCache();
+    const OmniUsdResolverContext* context = context_stack::GetContext();
+    const bool hasPartition = context && context->GetPartition();
+
+    // Only identifiers that are not already cached need to be resolved. Duplicates are resolved once
+    std::vector<std::string> pending;
+    std::unordered_map<std::string_view, size_t> pendingIndices;
+    std::vector<size_t> resultIndices(identifiers.size(), SIZE_MAX);
+    for (size_t i = 0; i < identifiers.size(); ++i)
+    {
+        const std::string_view identifierStripped = _StripFormatArgs(identifiers[i]);
+        if (hasPartition && _IsSearchPath(identifierStripped))
+        {
+            // Search paths resolve in the partition of the bound context, which the batch does not know about
+            results[i] = _ResolveThroughCache(identifiers[i]);
+            continue;
+        }
+        results[i] = cache ? cache->Get(identifierStripped) : nullptr;
+        if (!results[i] && (results[i] = mdl_helper::GetResolvedBuiltin(identifierStripped)) && cache)
+        {
+            cache->Add(identifierStripped, results[i]);
+        }
+        // Relative identifiers depend on the bound context, which the global cache does not know about
+        const bool isAbsolute = !isRelativePath(identifierStripped);
+        if (!results[i] && isAbsolute)
+        {
+            results[i] = global_cache::Get(identifierStripped);
+        }
+        if (!results[i] && (results[i] = resolve_index::Get(identifierStripped)))
+        {
+            if (isAbsolute)
+            {
+                global_cache::Add(identifierStripped, results[i]);
+            }
+            if (cache)
+            {
+                cache->Add(identifierStripped, results[i]);
+            }
+        }
+        if (results[i])
+        {
+            continue;
+        }
+
+        // The views point into identifiers, which outlives pendingIndices
+        auto inserted = pendingIndices.emplace(identifierStripped, pending.size());
+        if (inserted.second)
+        {
+            pending.emplace_back(identifierStripped);
+        }
+        resultIndices[i] = inserted.first->second;
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER)
+        .Msg("%s: resolving %zu of %zu identifiers\n", TF_FUNC_NAME().c_str(), pending.size(), identifiers.size());
+
+    std::vector<OmniUsdResolverCache::Entry> resolved;
+    ResolverHelper::ResolveBatch(pending, resolved);
+
+    std::vector<OmniUsdResolverCache::EntryPtr> resolvedPtrs;
+    resolvedPtrs.reserve(pending.size());
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        resolved[i].identifier = pending[i];
+        resolvedPtrs.push_back(std::make_shared<const OmniUsdResolverCache::Entry>(std::move(resolved[i])));
+        if (!resolvedPtrs[i]->resolvedPath.empty())
+        {
+            if (!isRelativePath(pending[i]))
+            {
+                global_cache::Add(pending[i], resolvedPtrs[i]);
+            }
+            resolve_index::Add(pending[i], resolvedPtrs[i]);
+            mdl_helper::SetResolvedBuiltin(pending[i], resolvedPtrs[i]);
+        }
+
+        if (cache)
+        {
+            cache->Add(pending[i], resolvedPtrs[i]);
+        }
+    }
+
+    for (size_t i = 0; i < identifiers.size(); ++i)
+    {
+        if (resultIndices[i] != SIZE_MAX)
+        {
+            results[i] = resolvedPtrs[resultIndices[i]];
+        }
+    }
+
+    return results;
+}
+
+size_t OmniUsdResolver::GetCacheFootprint() const
+{
+    auto cache = m_threadCache.GetCurrentCache();
+    return global_cache::GetFootprint() + (cache ? cache->GetFootprint() : 0);
+}
+
+OmniUsdResolverScopedCachePtr OmniUsdResolver::GetCurrentScopedCache() const
+{
+    return m_threadCache.GetCurrentCache();
+}
+
 ArResolvedPath OmniUsdResolver::_Resolve(const std::string& assetPath) const
 {
     auto cacheEntry = _ResolveThroughCache(assetPath);
 
     TF_DEBUG(OMNI_USD_RESOLVER)
-        .Msg("%s: %s -> %s\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), cacheEntry.resolvedPath.c_str());
+        .Msg("%s: %s -> %s\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), cacheEntry->resolvedPath.c_str());
 
-    return ArResolvedPath(std::move(cacheEntry.resolvedPath));
+    return ArResolvedPath(cacheEntry->resolvedPath);
 }
 ArResolvedPath OmniUsdResolver::_ResolveForNewAsset(const std::string& assetPath) const
 {
@@ -194,7 +507,7 @@ ArResolvedPath OmniUsdResolver::_ResolveForNewAsset(const std::string& assetPath
     // and do not require calls such as mkdir. Normal file paths will have their directories created when
     // the asset is opened for writing.
     // We are intentionally not using the cache here since the layer has not been created yet.
-    auto resolvedUrl = resolveUrl(assetPath);
+    auto resolvedUrl = parseUrl(context_stack::CombineWithAnchor(assetPath));
     if (isLocal(resolvedUrl))
     {
         // Local files can be accessed directly
@@ -227,7 +540,58 @@ ArResolverContext OmniUsdResolver::_CreateContextFromString(const std::string& c
     // the entire context from JSON or a file path to a JSON file (or XML, or YAML, etc.).
     // The separate function here makes it easier for implementations to know that the context is being hydrated
     // from something string-like and not make that determination in _CreateDefaultContextForAsset
-    return {};
+    //
+    // Two forms are supported:
+    // > {"assetPath": "omniverse://server/stage.usd", "searchPaths": ["omniverse://server/lib/", "/local/lib"]}
+    // > omniverse://server/lib/;/local/lib
+    // ';' is used to separate search paths since ':' is part of most URLs
+    const std::string trimmed = TfStringTrim(contextStr);
+    if (trimmed.empty())
+    {
+        return {};
+    }
+
+    std::string assetPath;
+    std::vector<std::string> searchPaths;
+    if (trimmed.front() == '{')
+    {
+        JsParseError error;
+        const JsValue value = JsParseString(trimmed, &error);
+        if (!value.IsObject())
+        {
+            TF_WARN("Unable to parse resolver context '%s': %s (line %u, column %u)", trimmed.c_str(),
+                    error.reason.c_str(), error.line, error.column);
+            return {};
+        }
+
+        const JsObject& object = value.GetJsObject();
+        auto it = object.find("assetPath");
+        if (it != object.end() && it->second.IsString())
+        {
+            assetPath = it->second.GetString();
+        }
+
+        it = object.find("searchPaths");
+        if (it != object.end() && it->second.IsArrayOf<std::string>())
+        {
+            searchPaths = it->second.GetArrayOf<std::string>();
+        }
+    }
+    else
+    {
+        for (const auto& searchPath : TfStringSplit(trimmed, ";"))
+        {
+            std::string path = TfStringTrim(searchPath);
+            if (!path.empty())
+            {
+                searchPaths.push_back(std::move(path));
+            }
+        }
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT)
+        .Msg("%s: %s with %zu search paths\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), searchPaths.size());
+    return { OmniUsdResolverContext(std::move(assetPath), std::move(searchPaths)) };
 }
 bool OmniUsdResolver::_IsContextDependentPath(const std::string& assetPath) const
 {
@@ -242,16 +606,31 @@ bool OmniUsdResolver::_IsContextDependentPath(const std::string& assetPath) cons
 }
 void OmniUsdResolver::_RefreshContext(const ArResolverContext& context)
 {
-    // There is nothing really to refresh for the OmniUsdResolverContext. If our context was populated
-    // with information from Nucleus and cached locally, this would be the place to refresh that cache
+    // There is nothing really to refresh for the OmniUsdResolverContext itself. But a refresh is an explicit
+    // request to pick up changes from the asset management system, so any resolves held in the global cache
+    // are no longer trustworthy
+    TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT)
+        .Msg("%s: flushing the context partition, global cache, search path cache and resolve index\n",
+             TF_FUNC_NAME().c_str());
+    if (auto* ctx = context.Get<OmniUsdResolverContext>())
+    {
+        if (ctx->GetPartition())
+        {
+            ctx->GetPartition()->Clear();
+        }
+    }
+    global_cache::Clear();
+    search_path_cache::Clear();
+    resolve_index::Clear();
 }
 
 void OmniUsdResolver::_BindContext(const ArResolverContext& context, VtValue* bindingData)
 {
-    static const std::string kEmpty;
+    // Contexts are tracked per thread by the resolver rather than pushed onto the base URL stack of client-library,
+    // so binding a context never has to synchronize with other threads
     if (context.IsEmpty())
     {
-        omniClientPushBaseUrl(kEmpty.c_str());
+        context_stack::Push({});
     }
     else
     {
@@ -259,40 +638,46 @@ void OmniUsdResolver::_BindContext(const ArResolverContext& context, VtValue* bi
         if (!ctx)
         {
             OMNI_LOG_ERROR("Unknown resolver context object: %s", context.GetDebugString().c_str());
-            omniClientPushBaseUrl(kEmpty.c_str());
+            context_stack::Push({});
         }
         else
         {
             TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT).Msg("%s: Bound %s\n", TF_FUNC_NAME().c_str(), ctx->GetAssetPath().c_str());
-            omniClientPushBaseUrl(ctx->GetAssetPath().c_str());
+            context_stack::Push(*ctx);
         }
     }
 }
 void OmniUsdResolver::_UnbindContext(const ArResolverContext& context, VtValue* bindingData)
 {
-    static const std::string kEmpty;
-    if (context.IsEmpty())
-    {
-        omniClientPopBaseUrl(kEmpty.c_str());
-    }
-    else
+    static const OmniUsdResolverContext kEmpty;
+    const OmniUsdResolverContext* ctx = &kEmpty;
+    if (!context.IsEmpty())
     {
-        auto* ctx = context.Get<OmniUsdResolverContext>();
+        ctx = context.Get<OmniUsdResolverContext>();
         if (!ctx)
         {
             OMNI_LOG_ERROR("Unknown resolver context object: %s", context.GetDebugString().c_str());
-            omniClientPopBaseUrl(kEmpty.c_str());
+            ctx = &kEmpty;
         }
         else
         {
             TF_DEBUG(OMNI_USD_RESOLVER_CONTEXT).Msg("%s: Unbound %s\n", TF_FUNC_NAME().c_str(), ctx->GetAssetPath().c_str());
-            omniClientPopBaseUrl(ctx->GetAssetPath().c_str());
         }
     }
+
+    if (!context_stack::Pop(*ctx))
+    {
+        TF_CODING_ERROR("Unbinding %s which is not the innermost bound context", context.GetDebugString().c_str());
+    }
 }
 
 ArResolverContext OmniUsdResolver::_GetCurrentContext() const
 {
+    if (const OmniUsdResolverContext* ctx = context_stack::GetContext())
+    {
+        return { *ctx };
+    }
+
     return { OmniUsdResolverContext(safeString(omniClientGetBaseUrl())) };
 }
 
@@ -314,30 +699,30 @@ ArTimestamp OmniUsdResolver::_GetModificationTimestamp(const std::string& assetP
     double timestamp{ 0 };
 
     auto cacheEntry = _ResolveThroughCache(assetPath);
-    if (!cacheEntry.resolvedPath.empty())
+    if (!cacheEntry->resolvedPath.empty())
     {
         // Only use the version string for omniverse URLs as they are usually monotonically increasing
         // Other providers such as S3 will return an etag (similar to a hash) in which case using the modTime
         // is preferred. For local files we will also want to use modTime as they don't support version numbers
-        if (!cacheEntry.version.empty() && isOmniverse(parseUrl(cacheEntry.url)))
+        if (!cacheEntry->version.empty() && isOmniverse(cacheEntry->url))
         {
             TF_DEBUG(OMNI_USD_RESOLVER)
-                .Msg("%s: using version %s as timestamp for %s\n", TF_FUNC_NAME().c_str(), cacheEntry.version.c_str(),
-                     cacheEntry.resolvedPath.c_str());
+                .Msg("%s: using version %s as timestamp for %s\n", TF_FUNC_NAME().c_str(), cacheEntry->version.c_str(),
+                     cacheEntry->resolvedPath.c_str());
 
             // version is a string and is not guaranteed to be a number which can cause problems
             // if the version is something like "2-good" or "2-better". This will result in the timestamp
             // being 2.0 which might not properly reload.
-            timestamp = TfStringToDouble(cacheEntry.version);
+            timestamp = TfStringToDouble(cacheEntry->version);
         }
         else
         {
-            timestamp = std::chrono::duration<double>(cacheEntry.modifiedTime.time_since_epoch()).count();
+            timestamp = std::chrono::duration<double>(cacheEntry->modifiedTime.time_since_epoch()).count();
         }
     }
 
     TF_DEBUG(OMNI_USD_RESOLVER)
-        .Msg("%s: %s, %s -> %f\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), cacheEntry.resolvedPath.c_str(), timestamp);
+        .Msg("%s: %s, %s -> %f\n", TF_FUNC_NAME().c_str(), assetPath.c_str(), cacheEntry->resolvedPath.c_str(), timestamp);
 
     return ArTimestamp(timestamp);
 }
@@ -350,9 +735,9 @@ ArAssetInfo OmniUsdResolver::_GetAssetInfo(const std::string& assetPath, const A
     auto cacheEntry = _ResolveThroughCache(assetPath);
 
     ArAssetInfo assetInfo;
-    assetInfo.version = std::move(cacheEntry.version);
-    assetInfo.repoPath = cacheEntry.url; // repoPath is deprecated; use "url" within resolverInfo instead
-    assetInfo.resolverInfo = VtDictionary{ { "url", VtValue(cacheEntry.url) }, { "size", VtValue(cacheEntry.size) } };
+    assetInfo.version = cacheEntry->version;
+    assetInfo.repoPath = cacheEntry->url; // repoPath is deprecated; use "url" within resolverInfo instead
+    assetInfo.resolverInfo = VtDictionary{ { "url", VtValue(cacheEntry->url) }, { "size", VtValue(cacheEntry->size) } };
 
     return assetInfo;
 }
@@ -361,16 +746,61 @@ std::shared_ptr<ArAsset> OmniUsdResolver::_OpenAsset(const ArResolvedPath& resol
     OMNI_TRACE_SCOPE(__FUNCTION__)
     TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
 
-    auto parsedUrl = parseUrl(resolvedPath.GetPathString());
-    if (isLocal(parsedUrl))
+    // Usd hands paths inside of packages to its package resolvers, which open the package itself through this
+    // resolver. They only get here when this resolver is used directly, i.e through ArGetUnderlyingResolver
+    if (ArIsPackageRelativePath(resolvedPath.GetPathString()))
+    {
+        const auto packagePath = ArSplitPackageRelativePathOuter(resolvedPath.GetPathString());
+        auto package = _OpenPackage(ArResolvedPath(packagePath.first));
+        return package ? package->OpenPackagedAsset(packagePath.second) : nullptr;
+    }
+
+    std::string buffer;
+    const UrlView url = breakUrlView(resolvedPath.GetPathString(), buffer);
+    if (url.local)
     {
         TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
             .Msg("%s: %s is a filesystem asset\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
-        return ArFilesystemAsset::Open(ArResolvedPath(fixLocalPath(parsedUrl->path)));
+        return ArFilesystemAsset::Open(ArResolvedPath(fixLocalPath(std::string(url.path))));
+    }
+
+    // Usd opens the package again for every file inside of it, so the opened package is shared between them
+    if (_StrToLower(std::string(getExtension(url.path))) == "usdz")
+    {
+        auto package = _OpenPackage(resolvedPath);
+        return package ? package->GetAsset() : nullptr;
+    }
+
+    // Large assets can be read while they are still downloading if a range reader has been registered
+    if (auto streamingAsset = OmniUsdStreamingAsset::Open(resolvedPath))
+    {
+        return streamingAsset;
     }
 
     return OmniUsdAsset::Open(resolvedPath);
 }
+
+std::shared_ptr<OmniUsdPackage> OmniUsdResolver::_OpenPackage(const ArResolvedPath& resolvedPath) const
+{
+    // The cached package is only reused while the resolved version, modified time and size are unchanged. Usd resolves
+    // the package before opening it, so this is answered by the scoped or global cache unless they are cold
+    auto cacheEntry = _ResolveThroughCache(resolvedPath.GetPathString());
+    if (cacheEntry->resolvedPath.empty())
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: unable to resolve package %s\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
+        return nullptr;
+    }
+
+    const std::string version = TfStringPrintf(
+        "%s:%lld:%llu", cacheEntry->version.c_str(),
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   cacheEntry->modifiedTime.time_since_epoch())
+                                   .count()),
+        static_cast<unsigned long long>(cacheEntry->size));
+    return OmniUsdPackage::Open(resolvedPath, version);
+}
+
 bool OmniUsdResolver::_CanWriteAssetToPath(const ArResolvedPath& resolvedPath, std::string* whyNot) const
 {
     bool result = ResolverHelper::CanWrite(resolvedPath, whyNot);
@@ -384,6 +814,21 @@ bool OmniUsdResolver::_CanWriteAssetToPath(const ArResolvedPath& resolvedPath, s
         TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
             .Msg("%s: removed %s from cache\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
     }
+    if (global_cache::Remove(resolvedPath.GetPathString()))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: removed %s from global cache\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
+    }
+    resolve_index::Remove(resolvedPath.GetPathString());
+    prefetch::Remove(resolvedPath.GetPathString());
+    OmniUsdPackage::Remove(resolvedPath.GetPathString());
+
+    // A search path that did not resolve next to its anchor may do so once this asset has been written. Only
+    // identifiers anchored in a directory that contains it are affected
+    if (currentCache)
+    {
+        currentCache->InvalidateIdentifiers(resolvedPath.GetPathString());
+    }
 
     return result;
 }
@@ -395,23 +840,26 @@ std::shared_ptr<ArWritableAsset> OmniUsdResolver::_OpenAssetForWrite(const ArRes
         .Msg("%s: %s (writeMode=%d)\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str(),
              static_cast<int>(writeMode));
 
-    auto parsedUrl = parseUrl(resolvedPath.GetPathString());
-    if (isLocal(parsedUrl))
+    std::string buffer;
+    const UrlView url = breakUrlView(resolvedPath.GetPathString(), buffer);
+    if (url.local)
     {
         TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
             .Msg("%s: %s is a filesystem asset\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
-        return ArFilesystemWritableAsset::Create(ArResolvedPath(fixLocalPath(parsedUrl->path)), writeMode);
+        return ArFilesystemWritableAsset::Create(ArResolvedPath(fixLocalPath(std::string(url.path))), writeMode);
     }
 
     return OmniUsdWritableAsset::Open(resolvedPath, writeMode);
 }
 std::string OmniUsdResolver::_GetExtension(const std::string& assetPath) const
 {
-    auto parsedUri = parseUrl(assetPath);
-    auto extension = _StrToLower(TfGetExtension(parsedUri->path));
+    // This is called for every layer and asset path Sdf touches, so avoid breaking the URL with client-library
+    std::string buffer;
+    const UrlView url = breakUrlView(assetPath, buffer);
+    auto extension = _StrToLower(std::string(getExtension(url.path)));
 
     // Check for Alembic URLs and force the "omni" extension
-    if (!isLocal(parsedUri) && (
+    if (!url.local && (
         extension == "abc" ||
         extension == "fbx" ||
         extension == "gltf" ||
@@ -443,3 +891,119 @@ void OmniUsdResolver::_EndCacheScope(VtValue* cacheScopeData)
 {
     m_threadCache.EndCacheScope(cacheScopeData);
 }
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverResolveBatch(const char** identifiers,
+                            size_t count,
+                            void* userData,
+                            OmniUsdResolverResolveBatchCallback callback) OMNIUSDRESOLVER_NOEXCEPT
+{
+    std::vector<std::string> identifierStrs;
+    identifierStrs.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        identifierStrs.emplace_back(safeString(identifiers[i]));
+    }
+
+    std::vector<OmniUsdResolverCache::EntryPtr> entries;
+    auto* omniResolver = dynamic_cast<OmniUsdResolver*>(&ArGetUnderlyingResolver());
+    if (omniResolver)
+    {
+        entries = omniResolver->ResolveBatch(identifierStrs);
+    }
+    else
+    {
+        // OmniUsdResolver is not the primary resolver so there is nothing to batch. Fall back to resolving one at a
+        // time through whichever resolver is configured
+        TF_DEBUG(OMNI_USD_RESOLVER).Msg("%s: OmniUsdResolver is not the primary resolver\n", TF_FUNC_NAME().c_str());
+        entries.reserve(identifierStrs.size());
+        for (const auto& identifier : identifierStrs)
+        {
+            auto entry = std::make_shared<OmniUsdResolverCache::Entry>();
+            entry->identifier = identifier;
+            entry->resolvedPath = ArGetResolver().Resolve(identifier).GetPathString();
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    if (!callback)
+    {
+        return;
+    }
+
+    std::vector<OmniUsdResolverResolveResult> results(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& entry = *entries[i];
+        results[i].identifier = identifierStrs[i].c_str();
+        results[i].resolvedPath = entry.resolvedPath.c_str();
+        results[i].url = entry.url.c_str();
+        results[i].version = entry.version.c_str();
+        results[i].modifiedTimeNs =
+            entry.resolvedPath.empty() ? 0 : convertToTimeSinceUnixEpoch(entry.modifiedTime).count();
+        results[i].size = entry.resolvedPath.empty() ? 0 : entry.size;
+    }
+
+    callback(userData, results.data(), results.size());
+}
+
+OMNIUSDRESOLVER_EXPORT(size_t) omniUsdResolverGetCacheFootprint() OMNIUSDRESOLVER_NOEXCEPT
+{
+    auto* omniResolver = dynamic_cast<OmniUsdResolver*>(&ArGetUnderlyingResolver());
+    return omniResolver ? omniResolver->GetCacheFootprint() : 0;
+}
+
+namespace
+{
+const OmniUsdResolverCache* _GetCacheForTier(OmniUsdResolverCacheTier tier, OmniUsdResolverScopedCachePtr& scopedCache)
+{
+    if (tier == eOmniUsdResolverCacheTier_Global)
+    {
+        return &global_cache::GetCache();
+    }
+
+    auto* omniResolver = dynamic_cast<OmniUsdResolver*>(&ArGetUnderlyingResolver());
+    scopedCache = omniResolver ? omniResolver->GetCurrentScopedCache() : nullptr;
+    return scopedCache.get();
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(bool)
+omniUsdResolverGetCacheStats(OmniUsdResolverCacheTier tier, OmniUsdResolverCacheStats* stats) OMNIUSDRESOLVER_NOEXCEPT
+{
+    OmniUsdResolverScopedCachePtr scopedCache;
+    const OmniUsdResolverCache* cache = _GetCacheForTier(tier, scopedCache);
+    if (!cache || !stats)
+    {
+        return false;
+    }
+
+    const auto cacheStats = cache->GetStats();
+    stats->hits = cacheStats.hits;
+    stats->misses = cacheStats.misses;
+    stats->inserts = cacheStats.inserts;
+    stats->removes = cacheStats.removes;
+    stats->evictions = cacheStats.evictions;
+    stats->entries = cacheStats.entries;
+    stats->bytes = cacheStats.bytes;
+    return true;
+}
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverGetHottestCacheKeys(OmniUsdResolverCacheTier tier,
+                                   size_t count,
+                                   void* userData,
+                                   OmniUsdResolverCacheKeyCallback callback) OMNIUSDRESOLVER_NOEXCEPT
+{
+    OmniUsdResolverScopedCachePtr scopedCache;
+    const OmniUsdResolverCache* cache = _GetCacheForTier(tier, scopedCache);
+    if (!cache || !callback)
+    {
+        return;
+    }
+
+    for (const auto& key : cache->GetHottestKeys(count))
+    {
+        callback(userData, key.first.c_str(), key.second);
+    }
+}
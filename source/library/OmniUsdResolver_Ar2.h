@@ -11,6 +11,7 @@
 #pragma once
 
 #include "OmniUsdResolverCache.h"
+#include "utils/SingleFlight.h"
 
 #include <pxr/usd/ar/asset.h>
 #include <pxr/usd/ar/resolvedPath.h>
@@ -18,6 +19,12 @@
 #include <pxr/usd/ar/resolverContext.h>
 #include <pxr/usd/ar/writableAsset.h>
 
+#include <string>
+#include <vector>
+
+class ContextPartition;
+class OmniUsdPackage;
+
 /// \brief The Ar 2 implementation of the Omniverse Usd Resolver
 class OmniUsdResolver final : public PXR_NS::ArResolver
 {
@@ -25,6 +32,20 @@ public:
     OmniUsdResolver();
     virtual ~OmniUsdResolver();
 
+    /// \brief Resolves all \p identifiers concurrently, issuing every request before waiting on any of them.
+    ///
+    /// Identifiers already held by the active ArResolverScopedCache or the global cache are not resolved again.
+    /// The results are added to both caches the same way Resolve would add them.
+    /// \returns the resolved entries in the same order as \p identifiers
+    std::vector<OmniUsdResolverCache::EntryPtr> ResolveBatch(const std::vector<std::string>& identifiers) const;
+
+    /// \brief Returns the approximate number of bytes used by the global cache and the ArResolverScopedCache
+    /// that is active on the calling thread
+    size_t GetCacheFootprint() const;
+
+    /// \brief Returns the ArResolverScopedCache that is active on the calling thread, if any
+    OmniUsdResolverScopedCachePtr GetCurrentScopedCache() const;
+
 protected:
     // --------------------------------------------------------------------- //
     /// \anchor ArResolver_identifiers
@@ -160,5 +181,23 @@ protected:
 private:
     mutable OmniUsdResolverScopedCache m_threadCache;
 
-    OmniUsdResolverCache::Entry _ResolveThroughCache(const std::string& identifier) const;
+    /// Resolves that are currently in-flight. Threads that miss the cache for an identifier that is already
+    /// being resolved wait on that result instead of making another request
+    mutable SingleFlight<std::string, OmniUsdResolverCache::EntryPtr> m_inflightResolves;
+
+    OmniUsdResolverCache::EntryPtr _ResolveThroughCache(const std::string& identifier) const;
+
+    /// Returns true if the search path \p assetPath resolves when anchored to \p anchorAssetPath.
+    /// Failed probes are remembered in the search path cache when it is enabled
+    bool _ResolvesNextToAnchor(const std::string& assetPath,
+                               const PXR_NS::ArResolvedPath& anchorAssetPath,
+                               const std::string& anchoredAssetPath) const;
+
+    /// Resolves the search path \p assetPath against the search roots of \p partition.
+    /// Returns nullptr if it is not found under any of them
+    OmniUsdResolverCache::EntryPtr _ResolveInPartition(ContextPartition& partition, const std::string& assetPath) const;
+
+    /// Opens the package at \p resolvedPath, reusing the cached package if its version has not changed.
+    /// Returns nullptr if the package can not be opened
+    std::shared_ptr<OmniUsdPackage> _OpenPackage(const PXR_NS::ArResolvedPath& resolvedPath) const;
 };
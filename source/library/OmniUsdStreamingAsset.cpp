@@ -0,0 +1,279 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "OmniUsdStreamingAsset.h"
+
+#include "DebugCodes.h"
+#include "Notifications.h"
+#include "utils/PathUtils.h"
+#include "utils/PythonUtils.h"
+
+#include <pxr/base/tf/envSetting.h>
+
+#include <algorithm>
+#include <cstring>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_STREAMING_BLOCK_SIZE,
+                      1048576,
+                      "Number of bytes fetched by each ranged read of an asset that is still being downloaded");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_STREAMING_CACHE_BLOCKS,
+                      64,
+                      "Maximum number of blocks cached for each asset that is still being downloaded");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+std::mutex g_readerMutex;
+OmniUsdStreamingAsset::RangeReader g_reader;
+
+OmniUsdStreamingAsset::RangeReader _GetRangeReader()
+{
+    std::lock_guard<std::mutex> lock(g_readerMutex);
+    return g_reader;
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetRangeReader(void* userData,
+                              OmniUsdResolverRangeReadCallback callback,
+                              uint64_t minimumSize) OMNIUSDRESOLVER_NOEXCEPT
+{
+    std::lock_guard<std::mutex> lock(g_readerMutex);
+    g_reader.userData = userData;
+    g_reader.callback = callback;
+    g_reader.minimumSize = minimumSize;
+}
+
+std::shared_ptr<OmniUsdStreamingAsset> OmniUsdStreamingAsset::Open(const ArResolvedPath& resolvedPath)
+{
+    const RangeReader reader = _GetRangeReader();
+    if (!reader.callback)
+    {
+        return nullptr;
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str());
+
+    PyReleaseGil g;
+
+    struct StatResult
+    {
+        bool found = false;
+        uint64_t size = 0;
+    } stat;
+    omniClientWait(omniClientStat(resolvedPath.GetPathString().c_str(), &stat,
+                                  [](void* userData, OmniClientResult result, OmniClientListEntry const* entry) noexcept
+                                  {
+                                      if (result == eOmniClientResult_Ok && entry)
+                                      {
+                                          auto stat = static_cast<StatResult*>(userData);
+                                          stat->found = true;
+                                          stat->size = entry->size;
+                                      }
+                                  }));
+
+    if (!stat.found || stat.size < reader.minimumSize)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: not streaming %s (%s)\n", TF_FUNC_NAME().c_str(), resolvedPath.GetPathString().c_str(),
+                 stat.found ? "smaller than the minimum size" : "stat failed");
+        return nullptr;
+    }
+
+    SendNotification(
+        resolvedPath.GetPathString().c_str(), eOmniUsdResolverEvent_Reading, eOmniUsdResolverEventState_Started);
+    auto asset = std::make_shared<OmniUsdStreamingAsset>(resolvedPath.GetPathString(), stat.size, reader);
+    SendNotification(resolvedPath.GetPathString().c_str(), eOmniUsdResolverEvent_Reading,
+                     eOmniUsdResolverEventState_Success, stat.size);
+    return asset;
+}
+
+OmniUsdStreamingAsset::OmniUsdStreamingAsset(std::string url, size_t size, const RangeReader& reader)
+    : _url(std::move(url)),
+      _size(size),
+      _reader(reader),
+      _blockSize(static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_STREAMING_BLOCK_SIZE), 4096))),
+      _maxBlocks(static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_STREAMING_CACHE_BLOCKS), 1)))
+{
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: %s\n", TF_FUNC_NAME().c_str(), _url.c_str());
+
+    // Keep downloading the local file in the background. Once it is ready every read is served from it
+    _downloadRequestId = omniClientGetLocalFile(_url.c_str(), true, this, &OmniUsdStreamingAsset::_OnDownloaded);
+}
+
+OmniUsdStreamingAsset::~OmniUsdStreamingAsset()
+{
+    if (_downloadRequestId)
+    {
+        // Wait for the callback so it can not run after this asset is destroyed
+        omniClientStop(_downloadRequestId);
+        omniClientWait(_downloadRequestId);
+        _downloadRequestId = 0;
+    }
+}
+
+void OmniUsdStreamingAsset::_OnDownloaded(void* userData, OmniClientResult result, char const* localFilePath) noexcept
+{
+    auto self = static_cast<OmniUsdStreamingAsset*>(userData);
+    if (result != eOmniClientResult_Ok)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: unable to download %s. Reads will continue to use the range reader\n", TF_FUNC_NAME().c_str(),
+                 self->_url.c_str());
+        return;
+    }
+
+    OmniUsdReadableData inputData;
+    inputData.url = self->_url;
+    inputData.localFile = fixLocalPath(localFilePath);
+    inputData.file = local_file::Open(inputData.localFile, inputData.url);
+    if (!inputData.file)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: unable to open %s (%s)\n", TF_FUNC_NAME().c_str(), self->_url.c_str(),
+                 inputData.localFile.c_str());
+        return;
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: %s downloaded to %s\n", TF_FUNC_NAME().c_str(), self->_url.c_str(), inputData.localFile.c_str());
+
+    // The request is stopped by this asset so the OmniUsdAsset does not own it
+    std::atomic_store(&self->_localAsset, std::make_shared<OmniUsdAsset>(std::move(inputData)));
+
+    // The blocks are no longer needed once reads are served from the local file
+    std::lock_guard<std::mutex> lock(self->_blocksMutex);
+    self->_blocks.clear();
+    self->_lru.clear();
+}
+
+std::shared_ptr<OmniUsdAsset> OmniUsdStreamingAsset::_GetLocalAsset() const
+{
+    return std::atomic_load(&_localAsset);
+}
+
+size_t OmniUsdStreamingAsset::GetSize() const
+{
+    return _size;
+}
+
+std::shared_ptr<const char> OmniUsdStreamingAsset::GetBuffer() const
+{
+    if (!_GetLocalAsset())
+    {
+        PyReleaseGil g;
+        omniClientWait(_downloadRequestId);
+    }
+
+    if (auto localAsset = _GetLocalAsset())
+    {
+        return localAsset->GetBuffer();
+    }
+
+    // The download failed, so fall back to reading the whole asset with the range reader
+    std::shared_ptr<char> buffer(new char[_size], std::default_delete<char[]>());
+    if (Read(buffer.get(), _size, 0) != _size)
+    {
+        return nullptr;
+    }
+    return buffer;
+}
+
+size_t OmniUsdStreamingAsset::Read(void* out, size_t count, size_t offset) const
+{
+    if (auto localAsset = _GetLocalAsset())
+    {
+        return localAsset->Read(out, count, offset);
+    }
+
+    if (offset >= _size)
+    {
+        return 0;
+    }
+    count = std::min(count, _size - offset);
+
+    size_t numRead = 0;
+    while (numRead < count)
+    {
+        const size_t position = offset + numRead;
+        const size_t blockOffset = position % _blockSize;
+        const Block block = _GetBlock(position / _blockSize);
+        if (!block || block->size() <= blockOffset)
+        {
+            break;
+        }
+
+        const size_t numCopied = std::min(count - numRead, block->size() - blockOffset);
+        memcpy(static_cast<char*>(out) + numRead, block->data() + blockOffset, numCopied);
+        numRead += numCopied;
+    }
+    return numRead;
+}
+
+std::pair<FILE*, size_t> OmniUsdStreamingAsset::GetFileUnsafe() const
+{
+    if (auto localAsset = _GetLocalAsset())
+    {
+        return localAsset->GetFileUnsafe();
+    }
+    return std::make_pair(nullptr, 0);
+}
+
+OmniUsdStreamingAsset::Block OmniUsdStreamingAsset::_GetBlock(size_t index) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_blocksMutex);
+        auto it = _blocks.find(index);
+        if (it != _blocks.end())
+        {
+            _lru.splice(_lru.begin(), _lru, it->second.second);
+            return it->second.first;
+        }
+    }
+
+    // Fetch outside of the lock so reads of other blocks are not held up by the server
+    const size_t offset = index * _blockSize;
+    auto data = std::make_shared<std::vector<char>>(std::min(_blockSize, _size - offset));
+    int64_t numRead;
+    {
+        PyReleaseGil g;
+        numRead = _reader.callback(_reader.userData, _url.c_str(), offset, data->data(), data->size());
+    }
+    if (numRead < 0)
+    {
+        TF_RUNTIME_ERROR("Error occurred reading %zu bytes at offset %zu of %s", data->size(), offset, _url.c_str());
+        return nullptr;
+    }
+    data->resize(std::min(static_cast<size_t>(numRead), data->size()));
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: read block %zu of %s (%zu bytes)\n", TF_FUNC_NAME().c_str(), index, _url.c_str(), data->size());
+
+    Block block = std::move(data);
+    std::lock_guard<std::mutex> lock(_blocksMutex);
+    auto inserted = _blocks.emplace(index, std::make_pair(block, _lru.end()));
+    if (!inserted.second)
+    {
+        // Another thread fetched the same block
+        return inserted.first->second.first;
+    }
+    _lru.push_front(index);
+    inserted.first->second.second = _lru.begin();
+
+    while (_blocks.size() > _maxBlocks)
+    {
+        _blocks.erase(_lru.back());
+        _lru.pop_back();
+    }
+    return block;
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdAsset.h"
+#include "OmniUsdResolver.h"
+#include "UsdIncludes.h"
+
+#include <OmniClient.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/// \brief A ArAsset implementation that reads remote assets while they are being downloaded
+///
+/// OmniUsdAsset waits for the whole asset to be downloaded to the local file cache before it can be read. When a range
+/// reader has been registered with omniUsdResolverSetRangeReader this asset is used instead. The local file is
+/// downloaded in the background and, until it is ready, reads are served from a cache of fixed size blocks fetched
+/// with the range reader. Once the download has finished every call is forwarded to an OmniUsdAsset for the local file.
+class OmniUsdStreamingAsset final : public ArAsset
+{
+public:
+    struct RangeReader
+    {
+        void* userData = nullptr;
+        OmniUsdResolverRangeReadCallback callback = nullptr;
+        uint64_t minimumSize = 0;
+    };
+
+    OmniUsdStreamingAsset(std::string url, size_t size, const RangeReader& reader);
+    virtual ~OmniUsdStreamingAsset();
+
+    OmniUsdStreamingAsset(const OmniUsdStreamingAsset&) = delete;
+    OmniUsdStreamingAsset& operator=(const OmniUsdStreamingAsset&) = delete;
+
+    /// Opens the resolved asset for streaming reads. Returns nullptr if no range reader is registered, or the asset
+    /// is smaller than the minimum size of the range reader, in which case OmniUsdAsset should be used instead
+    static std::shared_ptr<OmniUsdStreamingAsset> Open(const ArResolvedPath& resolvedPath);
+
+    /// Returns the total number of bytes for the asset
+    virtual size_t GetSize() const override;
+
+    /// Returns the buffer of data for the asset. This waits for the background download to finish
+    virtual std::shared_ptr<const char> GetBuffer() const override;
+
+    /// \brief Reads data from the asset
+    /// \param[out] out holds the data that was read from the asset
+    /// \param count the number of bytes to read
+    /// \param offset the offset for \p out to begin reading the asset to
+    /// \return the number of bytes read from the asset
+    virtual size_t Read(void* out, size_t count, size_t offset) const override;
+
+    /// Returns the local file once the background download has finished. Until then the file is nullptr, and
+    /// the asset has to be read with Read
+    virtual std::pair<FILE*, size_t> GetFileUnsafe() const override;
+
+private:
+    using Block = std::shared_ptr<const std::vector<char>>;
+
+    static void _OnDownloaded(void* userData, OmniClientResult result, char const* localFilePath) noexcept;
+
+    std::shared_ptr<OmniUsdAsset> _GetLocalAsset() const;
+    Block _GetBlock(size_t index) const;
+
+    const std::string _url;
+    const size_t _size;
+    const RangeReader _reader;
+    const size_t _blockSize;
+    const size_t _maxBlocks;
+
+    OmniClientRequestId _downloadRequestId = 0;
+
+    // Set by the download callback and accessed with std::atomic_load/std::atomic_store
+    std::shared_ptr<OmniUsdAsset> _localAsset;
+
+    // Least recently used blocks are at the back of _lru
+    mutable std::mutex _blocksMutex;
+    mutable std::list<size_t> _lru;
+    mutable std::unordered_map<size_t, std::pair<Block, std::list<size_t>::iterator>> _blocks;
+};
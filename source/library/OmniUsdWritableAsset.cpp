@@ -13,9 +13,14 @@
 #include "Defines.h"
 
 #include "Checkpoint.h"
+#include "ContextPartition.h"
 #include "DebugCodes.h"
+#include "GlobalCache.h"
+#include "LocalFile.h"
 #include "Notifications.h"
 #include "OmniUsdResolver.h"
+#include "ResolveIndex.h"
+#include "SearchPathCache.h"
 #include "UsdIncludes.h"
 #include "utils/OmniClientUtils.h"
 #include "utils/PythonUtils.h"
@@ -41,8 +46,8 @@ std::shared_ptr<OmniUsdWritableAsset> OmniUsdWritableAsset::Open(const ArResolve
     OmniUsdWritableData outputData;
     outputData.url = resolvedPath.GetPathString();
 
-    auto parsedUrl = parseUrl(resolvedPath.GetPathString());
-    const std::string ext = TfGetExtension(parsedUrl->path);
+    std::string buffer;
+    const std::string ext(getExtension(breakUrlView(resolvedPath.GetPathString(), buffer).path));
 
     // XXX: Should ArchMakeTmpFile be used over ArchMakeTmpFileName for safety?
     static const std::string kPrefix{ "omni-usd-resolver" };
@@ -53,26 +58,30 @@ std::shared_ptr<OmniUsdWritableAsset> OmniUsdWritableAsset::Open(const ArResolve
     {
         // There is not an easy way around this. We can not append to a file in Nucleus
         // so we have to copy the file to a temporary location and then write to it
-        // In most cases the file will already be local and not require a download
+        // In most cases the file will already be local and not require a download, and cloning the local file
+        // avoids copying its content at all on filesystems that support it
         struct Context
         {
             bool copied;
             std::string error;
         };
-        Context context{ false, std::string() };
-        omniClientWait(omniClientCopyFile(outputData.url.c_str(), outputData.file.c_str(), &context,
-                                          [](void* userData, OmniClientResult result) noexcept
-                                          {
-                                              auto& context = *(Context*)userData;
-                                              if (result == eOmniClientResult_Ok)
-                                              {
-                                                  context.copied = true;
-                                              }
-                                              else
+        Context context{ local_file::Clone(outputData.url, outputData.file), std::string() };
+        if (!context.copied)
+        {
+            omniClientWait(omniClientCopyFile(outputData.url.c_str(), outputData.file.c_str(), &context,
+                                              [](void* userData, OmniClientResult result) noexcept
                                               {
-                                                  context.error = safeString(omniClientGetResultString(result));
-                                              }
-                                          }));
+                                                  auto& context = *(Context*)userData;
+                                                  if (result == eOmniClientResult_Ok)
+                                                  {
+                                                      context.copied = true;
+                                                  }
+                                                  else
+                                                  {
+                                                      context.error = safeString(omniClientGetResultString(result));
+                                                  }
+                                              }));
+        }
         if (context.copied)
         {
             outputData.safeFile = TfSafeOutputFile::Update(outputData.file);
@@ -89,6 +98,12 @@ std::shared_ptr<OmniUsdWritableAsset> OmniUsdWritableAsset::Open(const ArResolve
     {
         // Not much to do if we are just replacing the file
         outputData.safeFile = TfSafeOutputFile::Replace(outputData.file);
+
+        // Only replaced files are written from start to end, so they can be uploaded while they are written
+        if (outputData.safeFile.Get())
+        {
+            outputData.upload = streaming_upload::Begin(outputData.url, outputData.safeFile.Get());
+        }
     }
 
     if (!m.IsClean())
@@ -114,11 +129,20 @@ bool OmniUsdWritableAsset::Close()
     size_t urlBufferSize = sizeof(urlBuffer);
     auto fileUrl = omniClientMakeFileUrl(_outputData.file.c_str(), urlBuffer, &urlBufferSize);
 
+    // a streamed upload reads what is left to upload from the temporary file, so it has to be finished first
+    bool uploaded = false;
+    if (_outputData.upload)
+    {
+        PyReleaseGil g;
+        uploaded = _outputData.upload->Finish();
+    }
+
     // close the temporary file that we were writing to
     TfErrorMark m;
     _outputData.safeFile.Close();
     if (!m.IsClean())
     {
+        _outputData.upload.reset();
         SendNotification(_outputData.url.c_str(), eOmniUsdResolverEvent_Writing, eOmniUsdResolverEventState_Failure);
         TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: Unable to close %s\n", TF_FUNC_NAME().c_str(), _outputData.file.c_str());
         return false;
@@ -139,38 +163,64 @@ bool OmniUsdWritableAsset::Close()
     // Nucleus only provides precision down to the nearest second. See comments in
     // OmniUsdResolver::_GetModificationTimestamp on how this impacts things such as SdfLayer::Reload
 
-    // move all the content from the temporary file to output file URL
-    omniClientWait(omniClientMove(
-        fileUrl, _outputData.url.c_str(), &context,
-        [](void* userData, OmniClientResult result, bool copied) noexcept
-        {
-            auto& context = *static_cast<Context*>(userData);
-            context.deleted = (result == eOmniClientResult_Ok);
-            if (copied)
-            {
-                context.copied = true;
-            }
-            else
-            {
-                context.copied = context.deleted;
-            }
-        },
-        eOmniClientCopy_Overwrite, checkpointMessage.c_str()));
-
-    if (!context.deleted)
+    if (uploaded && _outputData.upload->Commit(checkpointMessage))
     {
-        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
-            .Msg("%s: copy of '%s' failed for '%s'\n", TF_FUNC_NAME().c_str(), fileUrl, _outputData.url.c_str());
+        context.copied = true;
 
-        // delete the temporary file even if the copy failed
+        // the content was uploaded from the temporary file, so it is no longer needed
         omniClientWait(omniClientDelete(fileUrl, nullptr, nullptr));
     }
+    else
+    {
+        if (_outputData.upload)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                .Msg("%s: streamed upload of '%s' failed, moving '%s' instead\n", TF_FUNC_NAME().c_str(),
+                     _outputData.url.c_str(), fileUrl);
+            _outputData.upload->Abort();
+        }
+
+        // move all the content from the temporary file to output file URL
+        omniClientWait(omniClientMove(
+            fileUrl, _outputData.url.c_str(), &context,
+            [](void* userData, OmniClientResult result, bool copied) noexcept
+            {
+                auto& context = *static_cast<Context*>(userData);
+                context.deleted = (result == eOmniClientResult_Ok);
+                if (copied)
+                {
+                    context.copied = true;
+                }
+                else
+                {
+                    context.copied = context.deleted;
+                }
+            },
+            eOmniClientCopy_Overwrite, checkpointMessage.c_str()));
+
+        if (!context.deleted)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+                .Msg("%s: copy of '%s' failed for '%s'\n", TF_FUNC_NAME().c_str(), fileUrl, _outputData.url.c_str());
+
+            // delete the temporary file even if the copy failed
+            omniClientWait(omniClientDelete(fileUrl, nullptr, nullptr));
+        }
+    }
 
     TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
         .Msg("%s: %s -> %s\n", TF_FUNC_NAME().c_str(), _outputData.url.c_str(), TfStringify(context.copied).c_str());
 
     if (context.copied)
     {
+        // The asset may have been resolved, and cached, by another thread while it was being written
+        global_cache::Remove(_outputData.url);
+        resolve_index::Remove(_outputData.url);
+        // A search path that previously failed to resolve next to a layer may now exist
+        search_path_cache::InvalidateUrl(_outputData.url);
+        // It may also have been added to a directory listed under the search roots of a context
+        ContextPartition::InvalidateAll();
+
         SendNotification(_outputData.url.c_str(), eOmniUsdResolverEvent_Writing, eOmniUsdResolverEventState_Success);
         return true;
     }
@@ -190,5 +240,10 @@ size_t OmniUsdWritableAsset::Write(const void* buffer, size_t count, size_t offs
         return 0;
     }
 
+    if (_outputData.upload)
+    {
+        _outputData.upload->Written(offset, static_cast<size_t>(bytesWritten));
+    }
+
     return bytesWritten;
 }
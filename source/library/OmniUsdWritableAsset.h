@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "StreamingUpload.h"
 #include "UsdIncludes.h"
 
 #include <pxr/base/tf/safeOutputFile.h>
@@ -20,12 +21,16 @@ struct OmniUsdWritableData
     std::string url;
     std::string file;
     TfSafeOutputFile safeFile;
+
+    /// Set if the file is uploaded to the sink registered with omniUsdResolverSetUploadSink while it is written
+    std::unique_ptr<streaming_upload::Upload> upload;
 };
 
 /// \brief A ArWritableAsset implementation that allows writing assets
 /// directly through the client-library to Omniverse
 ///
-/// This writes to a temporary file on disk then moves that content to Omniverse at close
+/// This writes to a temporary file on disk then moves that content to Omniverse at close, unless an upload sink has
+/// been registered in which case the temporary file is uploaded in chunks while it is written
 class OmniUsdWritableAsset final : public ArWritableAsset
 {
 public:
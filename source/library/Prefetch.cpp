@@ -0,0 +1,348 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "Prefetch.h"
+
+#include "DebugCodes.h"
+#include "OmniUsdResolver.h"
+#include "utils/OmniClientUtils.h"
+
+#include <pxr/base/tf/envSetting.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_PREFETCH_PARALLELISM,
+                      16,
+                      "Maximum number of local file downloads started by omniUsdResolverPrefetch that run at once");
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_PREFETCH_CACHE_SIZE,
+                      1024,
+                      "Maximum number of downloads started by omniUsdResolverPrefetch that finished but have not been "
+                      "opened. The oldest ones are stopped beyond it, and their local files are left to the client "
+                      "library cache");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+enum class State
+{
+    Queued,
+    Downloading,
+    Done
+};
+
+struct Download
+{
+    std::string url;
+    int32_t priority = 0;
+    State state = State::Queued;
+
+    // Set once omniClientGetLocalFile has returned the request
+    bool started = false;
+
+    // Set when the download is dropped before it was taken over, so its request has to be stopped
+    bool abandoned = false;
+
+    // Set while the finished download is in g_finished, waiting to be taken over
+    bool finished = false;
+    std::list<std::shared_ptr<Download>>::iterator finishedIt;
+
+    prefetch::Result result;
+};
+
+using DownloadPtr = std::shared_ptr<Download>;
+
+struct QueueItem
+{
+    int32_t priority;
+    uint64_t sequence;
+    DownloadPtr download;
+
+    // Higher priorities first, then in the order they were queued
+    bool operator<(const QueueItem& other) const
+    {
+        return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+    }
+};
+
+std::mutex g_mutex;
+std::condition_variable g_downloaded;
+std::unordered_map<std::string, DownloadPtr> g_downloads;
+std::priority_queue<QueueItem> g_queue;
+uint64_t g_sequence = 0;
+size_t g_active = 0;
+
+// Finished downloads that have not been taken over, oldest at the back
+std::list<DownloadPtr> g_finished;
+
+size_t _GetParallelism()
+{
+    static const size_t parallelism =
+        static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_PREFETCH_PARALLELISM), 1));
+    return parallelism;
+}
+
+size_t _GetCacheSize()
+{
+    static const size_t cacheSize =
+        static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_PREFETCH_CACHE_SIZE), 0));
+    return cacheSize;
+}
+
+// Moves queued downloads to toStart while there is room for them. Called with g_mutex held
+void _PopQueued(std::vector<DownloadPtr>& toStart)
+{
+    while (g_active < _GetParallelism() && !g_queue.empty())
+    {
+        QueueItem item = g_queue.top();
+        g_queue.pop();
+
+        // Skip downloads that were dropped, or queued again with a higher priority
+        const DownloadPtr& download = item.download;
+        if (download->abandoned || download->state != State::Queued || download->priority != item.priority)
+        {
+            continue;
+        }
+
+        download->state = State::Downloading;
+        g_active++;
+        toStart.push_back(download);
+    }
+}
+
+// Drops a download from g_finished once it is taken over or dropped. Called with g_mutex held
+void _Unfinish(Download& download)
+{
+    if (download.finished)
+    {
+        g_finished.erase(download.finishedIt);
+        download.finished = false;
+    }
+}
+
+// Marks a download that will not be taken over. Called with g_mutex held
+void _Abandon(const DownloadPtr& download, std::vector<OmniClientRequestId>& toStop)
+{
+    download->abandoned = true;
+    _Unfinish(*download);
+    if (download->started)
+    {
+        toStop.push_back(download->result.requestId);
+    }
+}
+
+// Each finished download holds its request, and the local file it keeps in the client library cache, until it is
+// taken over. Finished downloads are kept until there are more than the cache size of them, after which the oldest
+// ones are dropped. Called with g_mutex held
+void _Finish(const DownloadPtr& download, std::vector<OmniClientRequestId>& toStop)
+{
+    auto it = g_downloads.find(download->url);
+    if (it == g_downloads.end() || it->second != download)
+    {
+        // Taken over while it was downloading, or dropped
+        return;
+    }
+
+    g_finished.push_front(download);
+    download->finished = true;
+    download->finishedIt = g_finished.begin();
+
+    while (g_finished.size() > _GetCacheSize())
+    {
+        DownloadPtr oldest = g_finished.back();
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: dropped %s, which was not opened\n", TF_FUNC_NAME().c_str(), oldest->url.c_str());
+        g_downloads.erase(oldest->url);
+        _Abandon(oldest, toStop);
+    }
+}
+
+void _Start(const std::vector<DownloadPtr>& downloads);
+
+void _OnDownloaded(void* userData, OmniClientResult result, char const* localFilePath) noexcept
+{
+    std::unique_ptr<DownloadPtr> holder(static_cast<DownloadPtr*>(userData));
+    const DownloadPtr& download = *holder;
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: %s %s\n", TF_FUNC_NAME().c_str(), download->url.c_str(),
+             result == eOmniClientResult_Ok ? "downloaded" : "failed to download");
+
+    std::vector<DownloadPtr> toStart;
+    std::vector<OmniClientRequestId> toStop;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (result == eOmniClientResult_Ok)
+        {
+            download->result.localFile = localFilePath;
+        }
+        download->state = State::Done;
+        g_active--;
+        _Finish(download, toStop);
+        _PopQueued(toStart);
+    }
+    g_downloaded.notify_all();
+
+    for (auto requestId : toStop)
+    {
+        omniClientStop(requestId);
+    }
+    _Start(toStart);
+}
+
+// Starts the downloads outside of g_mutex, since the callback can be called before omniClientGetLocalFile returns
+void _Start(const std::vector<DownloadPtr>& downloads)
+{
+    for (const auto& download : downloads)
+    {
+        const OmniClientRequestId requestId =
+            omniClientGetLocalFile(download->url.c_str(), true, new DownloadPtr(download), &_OnDownloaded);
+
+        bool abandoned;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            download->result.requestId = requestId;
+            download->started = true;
+            abandoned = download->abandoned;
+        }
+        g_downloaded.notify_all();
+
+        if (abandoned)
+        {
+            omniClientStop(requestId);
+        }
+    }
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverPrefetch(const char** urls, size_t count, int32_t priority) OMNIUSDRESOLVER_NOEXCEPT
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (urls[i] && urls[i][0])
+        {
+            prefetch::Add(urls[i], priority);
+        }
+    }
+}
+
+namespace prefetch
+{
+void Add(std::string_view url, int32_t priority)
+{
+    // Local files can be opened directly
+    if (isLocal(url))
+    {
+        return;
+    }
+
+    std::vector<DownloadPtr> toStart;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto& download = g_downloads[std::string(url)];
+        if (!download)
+        {
+            download = std::make_shared<Download>();
+            download->url = std::string(url);
+        }
+        else if (download->state != State::Queued || priority <= download->priority)
+        {
+            return;
+        }
+
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: queued %s with priority %d\n", TF_FUNC_NAME().c_str(), download->url.c_str(), priority);
+
+        download->priority = priority;
+        g_queue.push(QueueItem{ priority, g_sequence++, download });
+        _PopQueued(toStart);
+    }
+
+    _Start(toStart);
+}
+
+bool Take(std::string_view url, Result& result)
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+    if (g_downloads.empty())
+    {
+        return false;
+    }
+
+    auto it = g_downloads.find(std::string(url));
+    if (it == g_downloads.end())
+    {
+        return false;
+    }
+
+    DownloadPtr download = std::move(it->second);
+    g_downloads.erase(it);
+    if (download->state == State::Queued)
+    {
+        download->abandoned = true;
+        return false;
+    }
+    _Unfinish(*download);
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: took over the download of %s\n", TF_FUNC_NAME().c_str(), download->url.c_str());
+
+    g_downloaded.wait(lock, [&download] { return download->state == State::Done && download->started; });
+    result = std::move(download->result);
+    return true;
+}
+
+void Remove(std::string_view url)
+{
+    std::vector<OmniClientRequestId> toStop;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_downloads.find(std::string(url));
+        if (it == g_downloads.end())
+        {
+            return;
+        }
+        _Abandon(it->second, toStop);
+        g_downloads.erase(it);
+    }
+
+    for (auto requestId : toStop)
+    {
+        omniClientStop(requestId);
+    }
+}
+
+void Clear()
+{
+    std::vector<OmniClientRequestId> toStop;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (auto& download : g_downloads)
+        {
+            _Abandon(download.second, toStop);
+        }
+        g_downloads.clear();
+        g_queue = std::priority_queue<QueueItem>();
+    }
+
+    for (auto requestId : toStop)
+    {
+        omniClientStop(requestId);
+    }
+}
+} // namespace prefetch
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include <OmniClient.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/// Local file downloads started ahead of OmniUsdAsset::Open with omniUsdResolverPrefetch.
+///
+/// Prefetched URLs are queued by priority and downloaded with a bounded number of concurrent requests. The first
+/// OmniUsdAsset::Open for a prefetched URL takes over its download, waiting for it if it is still in flight, instead
+/// of starting a download of its own.
+namespace prefetch
+{
+/// The local file downloaded for a prefetched URL
+struct Result
+{
+    /// The path to the local file. Empty if the download failed or was stopped
+    std::string localFile;
+
+    /// The request that downloaded the local file. The caller is responsible for stopping it
+    OmniClientRequestId requestId = 0;
+};
+
+/// \brief Queues the local file download of \p url
+/// \note URLs that are already queued, downloading or downloaded are only queued again with a higher priority
+void Add(std::string_view url, int32_t priority);
+
+/// \brief Takes over the prefetched download of \p url, waiting for it to finish if it is in flight
+/// \note A download that is still queued is dropped from the queue and false is returned so the caller downloads
+/// the file itself without waiting on other downloads
+/// \returns true if \p url was downloading or downloaded. Otherwise, false
+bool Take(std::string_view url, Result& result);
+
+/// \brief Drops the prefetched download of \p url, i.e because the asset is about to be written
+void Remove(std::string_view url);
+
+/// \brief Drops every queued download and stops every download that has not been taken over
+void Clear();
+} // namespace prefetch
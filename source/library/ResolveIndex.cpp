@@ -0,0 +1,566 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "ResolveIndex.h"
+
+#include "CacheKey.h"
+#include "DebugCodes.h"
+#include "OmniUsdResolver.h"
+#include "utils/PathUtils.h"
+#include "utils/Time.h"
+
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/debug.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/errorMark.h>
+#include <pxr/base/tf/safeOutputFile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_RESOLVE_INDEX,
+                      "",
+                      "Path to a file used to persist successful resolves across processes. Empty disables the index");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_RESOLVE_INDEX_STALENESS,
+                      600,
+                      "Number of seconds a resolve stored in the resolve index is trusted without resolving it again");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_RESOLVE_INDEX_SAVE_INTERVAL,
+                      60,
+                      "Number of seconds between saves of the resolve index while resolves are added to it. "
+                      "0 only saves it when the resolver is destroyed or omniUsdResolverSaveResolveIndex is called");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+// The on-disk layout is a header, followed by records sorted by the hash of their key, followed by a pool of
+// strings the records point into. The file is only ever read by the same build so it is stored in native byte order.
+constexpr char kMagic[8] = { 'O', 'M', 'N', 'I', 'R', 'I', 'D', 'X' };
+constexpr uint32_t kFormatVersion = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t stringsSize;
+};
+
+enum StringField : uint32_t
+{
+    eKey,
+    eUrl,
+    eResolvedPath,
+    eVersion,
+
+    Count_eStringField
+};
+
+struct Record
+{
+    uint64_t hash;
+    int64_t recordedNs;
+    int64_t modifiedTimeNs;
+    uint64_t size;
+    uint32_t offsets[Count_eStringField];
+    uint32_t lengths[Count_eStringField];
+};
+
+struct Pending
+{
+    // nullptr marks an entry that was removed
+    OmniUsdResolverCache::EntryPtr entry;
+    int64_t recordedNs;
+};
+
+int64_t _SecondsToNs(double seconds)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(std::max(seconds, 0.0)))
+        .count();
+}
+
+// g_saveMutex serializes saves and is always locked before g_mutex. The mapping is only replaced while holding both,
+// so a save can read it without holding g_mutex
+std::mutex g_saveMutex;
+
+// g_mutex guards everything below it, the atomics can be read without it
+std::mutex g_mutex;
+std::string g_path = TfGetEnvSetting(OMNI_USD_RESOLVER_RESOLVE_INDEX);
+std::atomic<bool> g_enabled{ !g_path.empty() };
+std::atomic<int64_t> g_stalenessNs{ _SecondsToNs(TfGetEnvSetting(OMNI_USD_RESOLVER_RESOLVE_INDEX_STALENESS)) };
+
+bool g_loaded = false;
+ArchConstFileMapping g_mapping;
+const Record* g_records = nullptr;
+uint32_t g_count = 0;
+const char* g_strings = nullptr;
+uint64_t g_stringsSize = 0;
+
+std::unordered_map<std::string, Pending> g_pending;
+bool g_mappedValid = false;
+bool g_dirty = false;
+// Incremented by Clear so a save that raced with it does not bring back what was cleared
+uint64_t g_clearCount = 0;
+
+const int64_t g_saveIntervalNs = _SecondsToNs(TfGetEnvSetting(OMNI_USD_RESOLVER_RESOLVE_INDEX_SAVE_INTERVAL));
+std::atomic<int64_t> g_lastSaveNs{ 0 };
+
+uint64_t _Hash(std::string_view key)
+{
+    // FNV-1a since the hash is persisted and std::hash is not guaranteed to be stable between processes
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int64_t _NowNs()
+{
+    return convertToTimeSinceUnixEpoch(std::chrono::system_clock::now()).count();
+}
+
+bool _IsFresh(int64_t recordedNs)
+{
+    return _NowNs() - recordedNs < g_stalenessNs.load(std::memory_order_relaxed);
+}
+
+// Only identifiers that do not depend on the context bound on the resolving thread are persisted
+bool _IsPersistable(std::string_view key)
+{
+    return !isRelativePath(key);
+}
+
+void _Unload()
+{
+    g_mappedValid = false;
+    g_records = nullptr;
+    g_count = 0;
+    g_strings = nullptr;
+    g_stringsSize = 0;
+    g_mapping.reset();
+}
+
+// Called with g_mutex held. Replaces the current mapping with the index at g_path, if it is valid
+bool _Map()
+{
+    _Unload();
+
+    std::string err;
+    ArchConstFileMapping mapping = ArchMapFileReadOnly(g_path, &err);
+    if (!mapping)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER).Msg("%s: no resolve index at %s: %s\n", TF_FUNC_NAME().c_str(), g_path.c_str(), err.c_str());
+        return false;
+    }
+
+    const size_t length = ArchGetFileMappingLength(mapping);
+    if (length < sizeof(Header))
+    {
+        TF_WARN("Ignoring truncated resolve index %s", g_path.c_str());
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, mapping.get(), sizeof(Header));
+    const uint64_t recordsSize = static_cast<uint64_t>(header.count) * sizeof(Record);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        sizeof(Header) + recordsSize + header.stringsSize != length)
+    {
+        TF_WARN("Ignoring invalid resolve index %s", g_path.c_str());
+        return false;
+    }
+
+    g_records = reinterpret_cast<const Record*>(mapping.get() + sizeof(Header));
+    g_count = header.count;
+    g_strings = mapping.get() + sizeof(Header) + recordsSize;
+    g_stringsSize = header.stringsSize;
+    g_mapping = std::move(mapping);
+    g_mappedValid = true;
+    return true;
+}
+
+// Called with g_mutex held
+void _Load()
+{
+    if (g_loaded)
+    {
+        return;
+    }
+    g_loaded = true;
+    g_lastSaveNs = _NowNs();
+
+    if (_Map())
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER)
+            .Msg("%s: loaded %u entries from %s\n", TF_FUNC_NAME().c_str(), g_count, g_path.c_str());
+    }
+}
+
+bool _GetString(const Record& record, StringField field, std::string_view& str)
+{
+    if (static_cast<uint64_t>(record.offsets[field]) + record.lengths[field] > g_stringsSize)
+    {
+        return false;
+    }
+
+    str = std::string_view(g_strings + record.offsets[field], record.lengths[field]);
+    return true;
+}
+
+OmniUsdResolverCache::EntryPtr _ToEntry(const Record& record)
+{
+    std::string_view strings[Count_eStringField];
+    for (uint32_t i = 0; i < Count_eStringField; ++i)
+    {
+        if (!_GetString(record, static_cast<StringField>(i), strings[i]))
+        {
+            return nullptr;
+        }
+    }
+
+    auto entry = std::make_shared<OmniUsdResolverCache::Entry>();
+    entry->identifier = strings[eKey];
+    entry->url = strings[eUrl];
+    entry->resolvedPath = strings[eResolvedPath];
+    entry->version = strings[eVersion];
+    entry->modifiedTime = convertFromTimeSinceUnixEpoch(std::chrono::nanoseconds(record.modifiedTimeNs));
+    entry->size = record.size;
+    return entry;
+}
+
+const Record* _FindMapped(std::string_view key)
+{
+    const uint64_t hash = _Hash(key);
+    const Record* end = g_records + g_count;
+    for (auto it = std::lower_bound(
+             g_records, end, hash, [](const Record& record, uint64_t hash) { return record.hash < hash; });
+         it != end && it->hash == hash; ++it)
+    {
+        std::string_view recordKey;
+        if (_GetString(*it, eKey, recordKey) && recordKey == key)
+        {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+bool _IsSame(const Pending& a, const Pending& b)
+{
+    return a.entry == b.entry && a.recordedNs == b.recordedNs;
+}
+
+// Called with g_saveMutex held. g_mutex is only held while taking a snapshot of the pending entries and while swapping
+// in the new index, so resolves are not blocked while the index is merged and written
+bool _Save()
+{
+    std::unordered_map<std::string, Pending> snapshot;
+    bool mappedValid = false;
+    uint64_t clearCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        _Load();
+        if (!g_dirty)
+        {
+            return true;
+        }
+
+        snapshot = g_pending;
+        mappedValid = g_mappedValid;
+        clearCount = g_clearCount;
+        g_dirty = false;
+    }
+
+    // Merge what was loaded with what was resolved by this process. Anything that is no longer fresh
+    // would not be trusted by the next process so there is no point in keeping it around
+    std::map<std::string, Pending> merged;
+    if (mappedValid)
+    {
+        for (uint32_t i = 0; i < g_count; ++i)
+        {
+            if (!_IsFresh(g_records[i].recordedNs))
+            {
+                continue;
+            }
+
+            if (auto entry = _ToEntry(g_records[i]))
+            {
+                std::string key = entry->identifier;
+                merged.emplace(std::move(key), Pending{ std::move(entry), g_records[i].recordedNs });
+            }
+        }
+    }
+    for (const auto& pending : snapshot)
+    {
+        if (pending.second.entry && _IsFresh(pending.second.recordedNs))
+        {
+            merged[pending.first] = pending.second;
+        }
+        else
+        {
+            merged.erase(pending.first);
+        }
+    }
+
+    std::vector<Record> records;
+    records.reserve(merged.size());
+    std::string strings;
+    for (const auto& item : merged)
+    {
+        const auto& entry = *item.second.entry;
+        const std::string* fields[Count_eStringField] = { &item.first, &entry.url, &entry.resolvedPath, &entry.version };
+
+        Record record{};
+        record.hash = _Hash(item.first);
+        record.recordedNs = item.second.recordedNs;
+        record.modifiedTimeNs = convertToTimeSinceUnixEpoch(entry.modifiedTime).count();
+        record.size = entry.size;
+        for (uint32_t i = 0; i < Count_eStringField; ++i)
+        {
+            record.offsets[i] = static_cast<uint32_t>(strings.size());
+            record.lengths[i] = static_cast<uint32_t>(fields[i]->size());
+            strings.append(*fields[i]);
+        }
+        records.push_back(record);
+    }
+    std::stable_sort(
+        records.begin(), records.end(), [](const Record& a, const Record& b) { return a.hash < b.hash; });
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.count = static_cast<uint32_t>(records.size());
+    header.stringsSize = strings.size();
+
+#ifdef _WIN32
+    // Windows can not replace a file that is still mapped. The loaded entries are kept in memory until the new index
+    // is mapped, without replacing anything that was added since the snapshot
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_clearCount == clearCount)
+        {
+            for (const auto& item : merged)
+            {
+                g_pending.emplace(item.first, item.second);
+            }
+        }
+        _Unload();
+    }
+#endif
+
+    // TfSafeOutputFile writes to a temporary file and renames it over the index when closed
+    // so other processes never see a partially written index
+    bool written = false;
+    {
+        TfErrorMark m;
+        TfSafeOutputFile file = TfSafeOutputFile::Replace(g_path);
+        if (!file.Get() || fwrite(&header, sizeof(header), 1, file.Get()) != 1 ||
+            (!records.empty() && fwrite(records.data(), sizeof(Record), records.size(), file.Get()) != records.size()) ||
+            (!strings.empty() && fwrite(strings.data(), 1, strings.size(), file.Get()) != strings.size()))
+        {
+            TF_WARN("Failed to write resolve index %s", g_path.c_str());
+            file.Discard();
+        }
+        else
+        {
+            file.Close();
+            written = m.IsClean();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!written)
+    {
+        g_dirty = true;
+        return false;
+    }
+
+    // A clear while writing means the new index still has what was cleared. g_dirty is set so the next save replaces it
+    if (g_clearCount != clearCount)
+    {
+        return true;
+    }
+
+    // Serve what was just written from the new mapping. Only the pending entries that were written, or dropped,
+    // are released so anything added while writing is kept until the next save. If another process replaced the
+    // index in the meantime its entries are used, but the pending entries are kept since they may not be in it
+    if (_Map() && g_count == header.count && g_stringsSize == header.stringsSize)
+    {
+        for (auto it = g_pending.begin(); it != g_pending.end();)
+        {
+            auto snapshotIt = snapshot.find(it->first);
+            auto mergedIt = merged.find(it->first);
+            if ((snapshotIt != snapshot.end() && _IsSame(it->second, snapshotIt->second)) ||
+                (mergedIt != merged.end() && _IsSame(it->second, mergedIt->second)))
+            {
+                it = g_pending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER)
+        .Msg("%s: saved %zu entries to %s\n", TF_FUNC_NAME().c_str(), records.size(), g_path.c_str());
+    return true;
+}
+} // namespace
+
+namespace resolve_index
+{
+bool IsEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+OmniUsdResolverCache::EntryPtr Get(std::string_view key)
+{
+    if (!IsEnabled() || !_IsPersistable(key))
+    {
+        return nullptr;
+    }
+
+    std::string buffer;
+    const std::string canonicalKey(cache_key::Canonicalize(key, buffer));
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    _Load();
+    auto it = g_pending.find(canonicalKey);
+    if (it != g_pending.end())
+    {
+        return it->second.entry && _IsFresh(it->second.recordedNs) ? it->second.entry : nullptr;
+    }
+
+    const Record* record = g_mappedValid ? _FindMapped(canonicalKey) : nullptr;
+    if (!record || !_IsFresh(record->recordedNs))
+    {
+        return nullptr;
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER).Msg("%s: %s found in resolve index\n", TF_FUNC_NAME().c_str(), canonicalKey.c_str());
+    return _ToEntry(*record);
+}
+
+void Add(std::string_view key, const OmniUsdResolverCache::EntryPtr& entry)
+{
+    if (!IsEnabled() || !entry || entry->resolvedPath.empty() || !_IsPersistable(key))
+    {
+        return;
+    }
+
+    std::string buffer;
+    std::string canonicalKey(cache_key::Canonicalize(key, buffer));
+
+    const int64_t now = _NowNs();
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_pending[std::move(canonicalKey)] = Pending{ entry, now };
+        g_dirty = true;
+    }
+
+    // Saving periodically means a process that never destroys the resolver, or exits without running destructors,
+    // only loses what it resolved since the last save. Only one of the threads adding entries does the save
+    int64_t lastSave = g_lastSaveNs.load(std::memory_order_relaxed);
+    if (g_saveIntervalNs > 0 && now - lastSave >= g_saveIntervalNs &&
+        g_lastSaveNs.compare_exchange_strong(lastSave, now))
+    {
+        Save();
+    }
+}
+
+void Remove(std::string_view key)
+{
+    if (!IsEnabled() || !_IsPersistable(key))
+    {
+        return;
+    }
+
+    std::string buffer;
+    std::string canonicalKey(cache_key::Canonicalize(key, buffer));
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_pending[std::move(canonicalKey)] = Pending{ nullptr, _NowNs() };
+    g_dirty = true;
+}
+
+void Clear()
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    // Loading it first makes sure a later save does not bring back what was in the file
+    _Load();
+    g_pending.clear();
+    g_mappedValid = false;
+    g_dirty = true;
+    ++g_clearCount;
+}
+
+bool Save()
+{
+    if (!IsEnabled())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_saveMutex);
+    return _Save();
+}
+
+void SetIndex(const std::string& path, double stalenessSeconds)
+{
+    std::lock_guard<std::mutex> saveLock(g_saveMutex);
+    if (g_enabled)
+    {
+        _Save();
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    _Unload();
+    g_pending.clear();
+    g_dirty = false;
+    g_loaded = false;
+    g_path = path;
+    g_stalenessNs = _SecondsToNs(stalenessSeconds);
+    g_enabled = !g_path.empty();
+
+    TF_DEBUG(OMNI_USD_RESOLVER)
+        .Msg("%s: using resolve index '%s' with a staleness of %f seconds\n", TF_FUNC_NAME().c_str(), g_path.c_str(),
+             stalenessSeconds);
+}
+} // namespace resolve_index
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetResolveIndex(const char* path, double stalenessSeconds) OMNIUSDRESOLVER_NOEXCEPT
+{
+    resolve_index::SetIndex(path ? path : "", stalenessSeconds);
+}
+
+OMNIUSDRESOLVER_EXPORT(bool) omniUsdResolverSaveResolveIndex() OMNIUSDRESOLVER_NOEXCEPT
+{
+    return resolve_index::Save();
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdResolverCache.h"
+
+#include <string>
+#include <string_view>
+
+/// A resolve index that persists successful resolves across processes.
+///
+/// When OMNI_USD_RESOLVER_RESOLVE_INDEX is set to a file path the index is memory-mapped the first time it is
+/// needed. Entries that were resolved within OMNI_USD_RESOLVER_RESOLVE_INDEX_STALENESS seconds are trusted without
+/// going to the server. Older entries are ignored and replaced by a fresh resolve. New resolves are kept in memory
+/// and merged into the file, atomically, when Save is called, which also happens every
+/// OMNI_USD_RESOLVER_RESOLVE_INDEX_SAVE_INTERVAL seconds while resolves are added. Only absolute identifiers are
+/// persisted since relative identifiers resolve against the context bound on the resolving thread.
+namespace resolve_index
+{
+/// \brief Returns true if a resolve index file has been configured
+bool IsEnabled();
+
+/// \brief Finds the entry in the resolve index located at \p key
+/// \returns the entry if the index is enabled and the entry is within the staleness window. Otherwise, nullptr
+OmniUsdResolverCache::EntryPtr Get(std::string_view key);
+
+/// \brief Adds a successful resolve to the resolve index
+void Add(std::string_view key, const OmniUsdResolverCache::EntryPtr& entry);
+
+/// \brief Removes the entry located at \p key so that it is not trusted by this, or any future, process
+void Remove(std::string_view key);
+
+/// \brief Removes all entries in the resolve index
+void Clear();
+
+/// \brief Writes the resolve index back to disk if anything changed
+/// \returns false if the index is disabled or could not be written
+bool Save();
+
+/// \brief Saves the current resolve index and switches to the file at \p path, which is loaded the next time it is
+/// needed. An empty \p path disables the resolve index
+void SetIndex(const std::string& path, double stalenessSeconds);
+} // namespace resolve_index
@@ -10,6 +10,7 @@
 
 #include "ResolverHelper.h"
 
+#include "ContextStack.h"
 #include "DebugCodes.h"
 #include "MdlHelper.h"
 #include "Notifications.h"
@@ -26,6 +27,103 @@
 
 #include <OmniClient.h>
 
+namespace
+{
+struct ResolveContext
+{
+    bool found;
+    std::string& url;
+    std::string& version;
+    std::chrono::system_clock::time_point& modifiedTime;
+    uint64_t& size;
+};
+
+void _ResolveCallback(void* userData, OmniClientResult result, struct OmniClientListEntry const* entry, char const* url) noexcept
+{
+    auto& context = *(ResolveContext*)userData;
+    if (result == eOmniClientResult_Ok)
+    {
+        context.found = true;
+        context.url = safeString(url);
+        context.version = safeString(entry->version);
+        context.modifiedTime = convertFromTimeSinceUnixEpoch(std::chrono::nanoseconds(entry->modifiedTimeNs));
+        context.size = entry->size;
+    }
+}
+
+OmniClientRequestId _StartResolve(const std::string& identifierStripped, ResolveContext& context)
+{
+    SendNotification(identifierStripped.c_str(), eOmniUsdResolverEvent_Resolving, eOmniUsdResolverEventState_Started);
+
+    if (mdl_helper::IsMdlIdentifier(identifierStripped))
+    {
+        // OMPE-16448: An MDL identifier (e.g nvidia/core_definitions.mdl) should not try to resolve against
+        // the bound context. It should only be resolved against the configured search paths.
+        // Bound contexts are not pushed to client-library, so its base URL only needs to be disabled when
+        // the application pushed one itself
+        const char* baseUrl = omniClientGetBaseUrl();
+        if (!baseUrl || !*baseUrl)
+        {
+            return omniClientResolve(identifierStripped.c_str(), {}, 0, &context, _ResolveCallback);
+        }
+
+        TF_DEBUG(OMNI_USD_RESOLVER_MDL)
+            .Msg("%s: Disabling base URL to resolve %s\n", TF_FUNC_NAME().c_str(), identifierStripped.c_str());
+
+        // The base URL is combined with the identifier when the request is issued, so it is safe to pop it
+        // before waiting on the request
+        omniClientPushBaseUrl("");
+        auto request = omniClientResolve(identifierStripped.c_str(), {}, 0, &context, _ResolveCallback);
+        omniClientPopBaseUrl("");
+        return request;
+    }
+
+    // The anchor of the context bound on this thread is passed explicitly. File-relative paths are anchored to it
+    // directly while search paths look next to it first and then in the configured search paths
+    const std::string* anchor = context_stack::GetAnchor();
+    if (anchor && isRelativePath(identifierStripped))
+    {
+        if (isFileRelative(identifierStripped))
+        {
+            const std::string url = makeString(omniClientCombineUrls, anchor->c_str(), identifierStripped.c_str());
+            return omniClientResolve(url.c_str(), {}, 0, &context, _ResolveCallback);
+        }
+
+        static const std::string kDot{ "." };
+        const std::string anchorDir = makeString(omniClientCombineUrls, anchor->c_str(), kDot.c_str());
+        const char* searchPaths[] = { anchorDir.c_str() };
+        return omniClientResolve(identifierStripped.c_str(), searchPaths, 1, &context, _ResolveCallback);
+    }
+
+    return omniClientResolve(identifierStripped.c_str(), {}, 0, &context, _ResolveCallback);
+}
+
+std::string _FinishResolve(const std::string& identifierStripped, const ResolveContext& context)
+{
+    auto eventFinished = eOmniUsdResolverEventState_Failure;
+    CARB_SCOPE_EXIT
+    {
+        SendNotification(identifierStripped.c_str(), eOmniUsdResolverEvent_Resolving, eventFinished, context.size);
+    };
+
+    if (!context.found)
+    {
+        return {};
+    }
+
+    std::string buffer;
+    const UrlView url = breakUrlView(context.url, buffer);
+    if (url.local)
+    {
+        // Local files can be accessed directly
+        return fixLocalPath(std::string(url.path));
+    }
+
+    eventFinished = eOmniUsdResolverEventState_Success;
+    return context.url;
+}
+} // namespace
+
 bool ResolverHelper::CanWrite(const std::string& resolvedPath, std::string* whyNot)
 {
     if (resolvedPath.empty())
@@ -202,75 +300,43 @@ std::string ResolverHelper::Resolve(const std::string& identifierStripped,
 {
     CARB_PROFILE_ZONE(1, "ResolverHelper::Resolve %s", identifierStripped.c_str());
 
-    SendNotification(identifierStripped.c_str(), eOmniUsdResolverEvent_Resolving, eOmniUsdResolverEventState_Started);
-    auto eventFinished = eOmniUsdResolverEventState_Failure;
-    CARB_SCOPE_EXIT
-    {
-        SendNotification(identifierStripped.c_str(), eOmniUsdResolverEvent_Resolving, eventFinished, size);
-    };
-
-    struct Context
-    {
-        bool found;
-        std::string& url;
-        std::string& version;
-        std::chrono::system_clock::time_point& modifiedTime;
-        uint64_t& size;
-    };
-    Context context = { false, url, version, modifiedTime, size };
-    auto callback =
-        [](void* userData, OmniClientResult result, struct OmniClientListEntry const* entry, char const* url) noexcept
-    {
-        auto& context = *(Context*)userData;
-        if (result == eOmniClientResult_Ok)
-        {
-            context.found = true;
-            context.url = safeString(url);
-            context.version = safeString(entry->version);
-            context.modifiedTime = convertFromTimeSinceUnixEpoch(std::chrono::nanoseconds(entry->modifiedTimeNs));
-            context.size = entry->size;
-        }
-    };
+    ResolveContext context = { false, url, version, modifiedTime, size };
+    auto request = _StartResolve(identifierStripped, context);
 
-    const bool isMdlIdentifier = mdl_helper::IsMdlIdentifier(identifierStripped);
-    if (isMdlIdentifier)
-    {
-        TF_DEBUG(OMNI_USD_RESOLVER_MDL)
-            .Msg("%s: Disabling base URL to resolve %s\n", TF_FUNC_NAME().c_str(), identifierStripped.c_str());
+    PyReleaseGil g;
+    omniClientWait(request);
 
-        // OMPE-16448: An MDL identifier (e.g nvidia/core_definitions.mdl) should not try to resolve against
-        // the current base URL. It should only be resolved against the configured search paths.
-        // Note that OmniUsdResolver::_BindContext will push the current layer's URL to the base URL stack
-        // which will be used as part of client-libraries resolve process
-        omniClientPushBaseUrl("");
-    }
+    // context.url is bound by reference to the passed in arg url
+    return _FinishResolve(identifierStripped, context);
+}
 
+void ResolverHelper::ResolveBatch(const std::vector<std::string>& identifiers,
+                                  std::vector<OmniUsdResolverCache::Entry>& entries)
+{
+    CARB_PROFILE_ZONE(1, "ResolverHelper::ResolveBatch %zu", identifiers.size());
 
-    // searchPaths are intentionally left empty here. Should the need arise to support searchPaths
-    // the OmniUsdResolverContext would be the ideal place to store them and use GetCurrentContext()
-    PyReleaseGil g;
-    omniClientWait(omniClientResolve(identifierStripped.c_str(), {}, 0, &context, callback));
+    entries.resize(identifiers.size());
 
-    if (isMdlIdentifier)
+    std::vector<ResolveContext> contexts;
+    contexts.reserve(identifiers.size());
+    for (auto& entry : entries)
     {
-        omniClientPopBaseUrl("");
+        contexts.push_back({ false, entry.url, entry.version, entry.modifiedTime, entry.size });
     }
 
-    if (!context.found)
+    // Issue every request up front so the round trips to the server overlap instead of being paid one at a time.
+    // contexts is never resized after this point so the addresses handed to client-library stay valid
+    std::vector<OmniClientRequestId> requests;
+    requests.reserve(identifiers.size());
+    for (size_t i = 0; i < identifiers.size(); ++i)
     {
-        return {};
+        requests.push_back(_StartResolve(identifiers[i], contexts[i]));
     }
 
-    auto parsedUrl = parseUrl(context.url);
-    if (isLocal(parsedUrl))
+    PyReleaseGil g;
+    for (size_t i = 0; i < identifiers.size(); ++i)
     {
-        // Local files can be accessed directly
-        return fixLocalPath(safeString(parsedUrl->path));
+        omniClientWait(requests[i]);
+        entries[i].resolvedPath = _FinishResolve(identifiers[i], contexts[i]);
     }
-
-    eventFinished = eOmniUsdResolverEventState_Success;
-
-    // context.url is bound by reference to the passed in arg url
-    // returning url or context.url is one of the same
-    return url;
 }
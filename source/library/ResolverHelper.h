@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
 /// \brief A utility class that assists with resolver-specific functions
 /// shared between Ar 1.0 and Ar 2.0. These functions should be valid to call
@@ -41,4 +42,12 @@ public:
                                std::string& version,
                                std::chrono::system_clock::time_point& modifiedTime,
                                uint64_t& size);
+
+    /// \brief Resolve all identifiers concurrently. Every request is issued before waiting on any of them,
+    /// so the latency for the whole batch is roughly that of the slowest resolve rather than the sum of all of them
+    /// \param identifiers the identifiers to resolve
+    /// \param[out] entries the resolved entries in the same order as \p identifiers. An entry with an empty
+    /// resolvedPath could not be resolved
+    static void ResolveBatch(const std::vector<std::string>& identifiers,
+                             std::vector<OmniUsdResolverCache::Entry>& entries);
 };
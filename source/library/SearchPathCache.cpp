@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "SearchPathCache.h"
+
+#include "DebugCodes.h"
+#include "OmniUsdResolver.h"
+
+#include <pxr/base/tf/debug.h>
+#include <pxr/base/tf/envSetting.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+PXR_NAMESPACE_OPEN_SCOPE
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_TTL,
+                      0,
+                      "Number of seconds a search path that failed to resolve next to the referencing layer is "
+                      "remembered. Zero disables the search path cache");
+
+TF_DEFINE_ENV_SETTING(OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_SIZE,
+                      16384,
+                      "Maximum number of failed search path probes held in the search path cache");
+PXR_NAMESPACE_CLOSE_SCOPE
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Miss
+{
+    std::string key;
+    size_t anchorDirLength;
+    Clock::time_point expires;
+};
+
+using MissList = std::list<Miss>;
+
+std::atomic<Clock::rep> g_ttl{ std::chrono::duration_cast<Clock::duration>(
+                                   std::chrono::seconds(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_TTL), 0)))
+                                   .count() };
+const size_t g_capacity = static_cast<size_t>(std::max(TfGetEnvSetting(OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_SIZE), 1));
+
+// Most recently used entries are at the front of g_misses
+std::mutex g_mutex;
+MissList g_misses;
+std::unordered_map<std::string, MissList::iterator> g_index;
+
+std::string _MakeKey(const std::string& anchorDir, const std::string& assetPath)
+{
+    // The anchor directory is stored as a prefix of the key so it can be matched when invalidating
+    std::string key;
+    key.reserve(anchorDir.size() + assetPath.size() + 1);
+    key.append(anchorDir).append(1, '\0').append(assetPath);
+    return key;
+}
+
+void _Erase(MissList::iterator it)
+{
+    g_index.erase(it->key);
+    g_misses.erase(it);
+}
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void) omniUsdResolverSetSearchPathCacheTtl(double seconds) OMNIUSDRESOLVER_NOEXCEPT
+{
+    const auto ttl = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.0)));
+    g_ttl.store(ttl.count(), std::memory_order_relaxed);
+
+    if (ttl == Clock::duration::zero())
+    {
+        search_path_cache::Clear();
+    }
+}
+
+namespace search_path_cache
+{
+bool IsEnabled()
+{
+    return g_ttl.load(std::memory_order_relaxed) > 0;
+}
+
+bool IsMissing(const std::string& anchorDir, const std::string& assetPath)
+{
+    if (!IsEnabled())
+    {
+        return false;
+    }
+
+    const std::string key = _MakeKey(anchorDir, assetPath);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_index.find(key);
+    if (it == g_index.end())
+    {
+        return false;
+    }
+
+    if (it->second->expires <= Clock::now())
+    {
+        _Erase(it->second);
+        return false;
+    }
+
+    g_misses.splice(g_misses.begin(), g_misses, it->second);
+    return true;
+}
+
+void AddMissing(const std::string& anchorDir, const std::string& assetPath)
+{
+    const Clock::duration ttl{ g_ttl.load(std::memory_order_relaxed) };
+    if (ttl <= Clock::duration::zero())
+    {
+        return;
+    }
+
+    std::string key = _MakeKey(anchorDir, assetPath);
+    const auto expires = Clock::now() + ttl;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_index.find(key);
+    if (it != g_index.end())
+    {
+        it->second->expires = expires;
+        g_misses.splice(g_misses.begin(), g_misses, it->second);
+        return;
+    }
+
+    while (g_misses.size() >= g_capacity)
+    {
+        _Erase(std::prev(g_misses.end()));
+    }
+
+    g_misses.push_front(Miss{ std::move(key), anchorDir.size(), expires });
+    g_index.emplace(g_misses.front().key, g_misses.begin());
+}
+
+void InvalidateUrl(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (auto it = g_misses.begin(); it != g_misses.end();)
+    {
+        auto next = std::next(it);
+        if (url.compare(0, it->anchorDirLength, it->key, 0, it->anchorDirLength) == 0)
+        {
+            TF_DEBUG(OMNI_USD_RESOLVER)
+                .Msg("%s: %s invalidated by %s\n", TF_FUNC_NAME().c_str(), it->key.c_str() + it->anchorDirLength + 1,
+                     url.c_str());
+            _Erase(it);
+        }
+        it = next;
+    }
+}
+
+void Clear()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_index.clear();
+    g_misses.clear();
+}
+} // namespace search_path_cache
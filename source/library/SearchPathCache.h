@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include <string>
+
+/// A bounded cache of "look here first" probes in OmniUsdResolver::_CreateIdentifier that failed to resolve.
+///
+/// Search paths are first anchored to the directory of the layer that references them. Almost all of those
+/// probes fail, so remembering the misses for a short time avoids asking the server the same question for
+/// every layer in the same directory. Entries are keyed on the anchor directory and the search path and expire
+/// after the time-to-live set with OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_TTL or omniUsdResolverSetSearchPathCacheTtl.
+/// The least recently used entry is evicted once OMNI_USD_RESOLVER_SEARCH_PATH_CACHE_SIZE entries are cached.
+namespace search_path_cache
+{
+/// \brief Returns true if the search path cache is enabled, i.e the time-to-live is greater than zero
+bool IsEnabled();
+
+/// \brief Returns true if \p assetPath was recently probed in \p anchorDir and did not resolve
+bool IsMissing(const std::string& anchorDir, const std::string& assetPath);
+
+/// \brief Records that \p assetPath anchored to \p anchorDir did not resolve
+void AddMissing(const std::string& anchorDir, const std::string& assetPath);
+
+/// \brief Removes all entries with an anchor directory that contains \p url
+/// \note This should be called whenever an asset is written so that a newly created asset is found
+void InvalidateUrl(const std::string& url);
+
+/// \brief Removes all entries in the search path cache
+void Clear();
+} // namespace search_path_cache
@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#include "StreamingUpload.h"
+
+#include "DebugCodes.h"
+
+#include <pxr/base/arch/fileSystem.h>
+
+#include <algorithm>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+constexpr uint64_t kDefaultChunkSize = 8 * 1024 * 1024;
+
+std::mutex g_sinkMutex;
+bool g_hasSink = false;
+OmniUsdResolverUploadSink g_sink{};
+uint64_t g_chunkSize = kDefaultChunkSize;
+} // namespace
+
+OMNIUSDRESOLVER_EXPORT(void)
+omniUsdResolverSetUploadSink(const struct OmniUsdResolverUploadSink* sink, uint64_t chunkSize) OMNIUSDRESOLVER_NOEXCEPT
+{
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    g_hasSink = sink && sink->begin && sink->chunk && sink->commit && sink->abort;
+    g_sink = g_hasSink ? *sink : OmniUsdResolverUploadSink{};
+    g_chunkSize = chunkSize > 0 ? chunkSize : kDefaultChunkSize;
+}
+
+namespace streaming_upload
+{
+std::unique_ptr<Upload> Begin(const std::string& url, FILE* file)
+{
+    OmniUsdResolverUploadSink sink;
+    uint64_t chunkSize;
+    {
+        std::lock_guard<std::mutex> lock(g_sinkMutex);
+        if (!g_hasSink)
+        {
+            return nullptr;
+        }
+        sink = g_sink;
+        chunkSize = g_chunkSize;
+    }
+
+    void* handle = sink.begin(sink.userData, url.c_str());
+    if (!handle)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: upload of %s was not started\n", TF_FUNC_NAME().c_str(), url.c_str());
+        return nullptr;
+    }
+
+    return std::make_unique<Upload>(sink, handle, static_cast<size_t>(chunkSize), url, file);
+}
+
+Upload::Upload(const OmniUsdResolverUploadSink& sink, void* handle, size_t chunkSize, std::string url, FILE* file)
+    : _sink(sink), _handle(handle), _chunkSize(chunkSize), _url(std::move(url)), _file(file)
+{
+    _thread = std::thread([this]() { _Run(); });
+}
+
+Upload::~Upload()
+{
+    Abort();
+}
+
+void Upload::Written(size_t offset, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t end = offset + count;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // The background thread may have read the previous content of these chunks
+    for (size_t chunk = offset - offset % _chunkSize; chunk < std::min(end, _claimed); chunk += _chunkSize)
+    {
+        _dirty.insert(chunk);
+    }
+
+    if (offset > _written)
+    {
+        auto& pendingEnd = _pending[offset];
+        pendingEnd = std::max(pendingEnd, end);
+        return;
+    }
+
+    _written = std::max(_written, end);
+    for (auto it = _pending.begin(); it != _pending.end() && it->first <= _written; it = _pending.erase(it))
+    {
+        _written = std::max(_written, it->second);
+    }
+
+    if (_written - _claimed >= _chunkSize)
+    {
+        _cv.notify_one();
+    }
+}
+
+bool Upload::Finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finishing = true;
+    }
+    _cv.notify_one();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    if (_failed)
+    {
+        return false;
+    }
+
+    // Anything after a gap that was never written is uploaded as it is in the file
+    const int64_t size = ArchGetFileLength(_file);
+    if (size < 0)
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: unable to get the size of %s\n", TF_FUNC_NAME().c_str(), _url.c_str());
+        return false;
+    }
+    _size = static_cast<size_t>(size);
+
+    std::unique_ptr<char[]> buffer(new char[_chunkSize]);
+    for (size_t offset = _claimed; offset < _size; offset += _chunkSize)
+    {
+        if (!_UploadRange(offset, std::min(_chunkSize, _size - offset), buffer.get()))
+        {
+            return false;
+        }
+    }
+    for (size_t offset : _dirty)
+    {
+        if (offset < std::min(_claimed, _size) &&
+            !_UploadRange(offset, std::min(_chunkSize, _size - offset), buffer.get()))
+        {
+            return false;
+        }
+    }
+
+    TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+        .Msg("%s: %s uploaded %zu bytes, %zu chunks uploaded again\n", TF_FUNC_NAME().c_str(), _url.c_str(), _size,
+             _dirty.size());
+    return true;
+}
+
+bool Upload::Commit(const std::string& message)
+{
+    if (_closed)
+    {
+        return false;
+    }
+
+    if (!_sink.commit(_sink.userData, _handle, _size, message.c_str()))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET).Msg("%s: commit of %s failed\n", TF_FUNC_NAME().c_str(), _url.c_str());
+        Abort();
+        return false;
+    }
+
+    _closed = true;
+    return true;
+}
+
+void Upload::Abort()
+{
+    if (_closed)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _failed = true;
+    }
+    _cv.notify_one();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    _closed = true;
+    _sink.abort(_sink.userData, _handle);
+}
+
+void Upload::_Run()
+{
+    std::unique_ptr<char[]> buffer(new char[_chunkSize]);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv.wait(lock, [this]() { return _failed || _finishing || _written - _claimed >= _chunkSize; });
+        if (_failed || _written - _claimed < _chunkSize)
+        {
+            return;
+        }
+
+        const size_t offset = _claimed;
+        _claimed += _chunkSize;
+
+        lock.unlock();
+        const bool uploaded = _UploadRange(offset, _chunkSize, buffer.get());
+        lock.lock();
+
+        if (!uploaded)
+        {
+            _failed = true;
+        }
+    }
+}
+
+bool Upload::_UploadRange(size_t offset, size_t count, char* buffer) const
+{
+    const int64_t numRead = ArchPRead(_file, buffer, count, static_cast<int64_t>(offset));
+    if (numRead != static_cast<int64_t>(count))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: unable to read %zu bytes at %zu of %s\n", TF_FUNC_NAME().c_str(), count, offset, _url.c_str());
+        return false;
+    }
+
+    if (!_sink.chunk(_sink.userData, _handle, offset, buffer, count))
+    {
+        TF_DEBUG(OMNI_USD_RESOLVER_ASSET)
+            .Msg("%s: upload of %zu bytes at %zu of %s failed\n", TF_FUNC_NAME().c_str(), count, offset, _url.c_str());
+        return false;
+    }
+
+    return true;
+}
+} // namespace streaming_upload
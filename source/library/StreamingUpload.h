@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "OmniUsdResolver.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+/// Uploads of assets opened for writing that are streamed to the sink registered with omniUsdResolverSetUploadSink.
+///
+/// OmniUsdWritableAsset still writes to a temporary file, but every chunk of the file is uploaded in the background as
+/// soon as it has been written, so closing the asset only has to upload the last chunk rather than the whole file.
+namespace streaming_upload
+{
+/// \brief A streamed upload of the temporary file an asset is written to
+///
+/// A chunk is uploaded once every byte from the start of the file to the end of the chunk has been written. Chunks
+/// that are written again after they were handed to the background thread, i.e the header usdc writes last, are
+/// uploaded again by Finish.
+class Upload
+{
+public:
+    Upload(const OmniUsdResolverUploadSink& sink, void* handle, size_t chunkSize, std::string url, FILE* file);
+
+    Upload(const Upload&) = delete;
+    Upload& operator=(const Upload&) = delete;
+
+    /// Aborts the upload if it was not committed
+    ~Upload();
+
+    /// Records that \p count bytes at \p offset were written to the file
+    void Written(size_t offset, size_t count);
+
+    /// \brief Waits for the background thread and uploads everything that has not been uploaded yet
+    /// \note Nothing can be written to the file after this is called, and it has to remain open until this returns
+    /// \returns false if a chunk failed to upload
+    bool Finish();
+
+    /// \brief Makes the uploaded file available at the URL of the asset. The upload is aborted if this fails
+    /// \returns true if the upload was committed. Otherwise, false
+    bool Commit(const std::string& message);
+
+    /// Discards the upload, unless it was already committed or aborted
+    void Abort();
+
+private:
+    void _Run();
+    bool _UploadRange(size_t offset, size_t count, char* buffer) const;
+
+    const OmniUsdResolverUploadSink _sink;
+    void* const _handle;
+    const size_t _chunkSize;
+    const std::string _url;
+    FILE* const _file;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+
+    // The end of the bytes that were written without a gap from the start of the file
+    size_t _written = 0;
+
+    // Ranges that were written after a gap, by offset
+    std::map<size_t, size_t> _pending;
+
+    // The end of the chunks handed to the background thread. Writes before it are uploaded again by Finish
+    size_t _claimed = 0;
+
+    // The offsets of chunks that have to be uploaded again
+    std::set<size_t> _dirty;
+
+    bool _finishing = false;
+    bool _failed = false;
+    bool _closed = false;
+    size_t _size = 0;
+
+    std::thread _thread;
+};
+
+/// \brief Starts a streamed upload of \p url from the temporary \p file it is written to
+/// \returns nullptr if no upload sink is registered or the sink did not start an upload
+std::unique_ptr<Upload> Begin(const std::string& url, FILE* file);
+} // namespace streaming_upload
@@ -3,12 +3,14 @@ import logging
 import os
 import random
 import string
+import sys
+import tempfile
 import unittest
 from functools import wraps
 
 import omni.client
 import omni.usd_resolver
-from pxr import Ar, Sdf, Usd
+from pxr import Ar, Sdf, Tf, Usd
 
 TEST_USER = os.environ.get("OMNI_TEST_USER", "omniverse")
 TEST_PASS = os.environ.get("OMNI_TEST_PASS", "omniverse")
@@ -253,6 +255,182 @@ class TestClient(unittest.TestCase):
         resolver = Ar.GetResolver()
         self.assertTrue(resolver.Resolve(layerIdentifier))
 
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_global_cache(self):
+        stage_url = f"{TESTSTAGE_URL}/Root.usda"
+
+        resolves = []
+
+        def event_callback(url, event, state, file_size):
+            if event == omni.usd_resolver.Event.RESOLVING and state == omni.usd_resolver.EventState.STARTED:
+                resolves.append(url)
+
+        omni.usd_resolver.set_global_cache_enabled(True)
+        omni.usd_resolver.flush_cache()
+        try:
+            resolver = Ar.GetResolver()
+            with omni.usd_resolver.register_event_callback(event_callback):
+                # Without an Ar.ResolverScopedCache only the first resolve should go through client-library
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertEqual(resolves.count(stage_url), 1)
+
+                # Flushing the cache should require the next resolve to go through client-library again
+                omni.usd_resolver.flush_cache()
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertEqual(resolves.count(stage_url), 2)
+
+                # A zero time-to-live should prevent the scheme from being cached
+                omni.usd_resolver.flush_cache()
+                omni.usd_resolver.set_global_cache_ttl("omniverse", 0)
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertEqual(resolves.count(stage_url), 4)
+        finally:
+            omni.usd_resolver.set_global_cache_ttl("omniverse", 30)
+            omni.usd_resolver.set_global_cache_enabled(False)
+
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_cache_budget(self):
+        stage_url = f"{TESTSTAGE_URL}/Root.usda"
+
+        resolver = Ar.GetResolver()
+        try:
+            with Ar.ResolverScopedCache():
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertGreater(omni.usd_resolver.get_cache_footprint(), 0)
+
+            # A budget smaller than a single entry should keep the scoped cache empty
+            omni.usd_resolver.set_cache_budget(1)
+            with Ar.ResolverScopedCache():
+                self.assertTrue(resolver.Resolve(stage_url))
+                self.assertEqual(omni.usd_resolver.get_cache_footprint(), 0)
+                self.assertTrue(resolver.Resolve(stage_url))
+        finally:
+            omni.usd_resolver.set_cache_budget(0)
+
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_cache_stats(self):
+        stage_url = f"{TESTSTAGE_URL}/Root.usda"
+
+        self.assertIsNone(omni.usd_resolver.get_cache_stats(omni.usd_resolver.CacheTier.SCOPED))
+        self.assertIsNotNone(omni.usd_resolver.get_cache_stats(omni.usd_resolver.CacheTier.GLOBAL))
+
+        resolver = Ar.GetResolver()
+        with Ar.ResolverScopedCache():
+            for _ in range(3):
+                self.assertTrue(resolver.Resolve(stage_url))
+
+            stats = omni.usd_resolver.get_cache_stats(omni.usd_resolver.CacheTier.SCOPED)
+            self.assertEqual(stats["misses"], 1)
+            self.assertEqual(stats["hits"], 2)
+            self.assertEqual(stats["inserts"], 1)
+            self.assertEqual(stats["entries"], 1)
+            self.assertGreater(stats["bytes"], 0)
+
+            hottest = omni.usd_resolver.get_hottest_cache_keys(omni.usd_resolver.CacheTier.SCOPED, 1)
+            self.assertEqual(len(hottest), 1)
+            self.assertEqual(hottest[0][1], 2)
+
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_search_path_cache(self):
+        anchor = Ar.ResolvedPath(f"{RANDOM_URL}/search_path_cache/anchor.usda")
+        search_path = "search_path_cache_asset.usda"
+        anchored_url = f"{RANDOM_URL}/search_path_cache/{search_path}"
+
+        resolves = []
+
+        def event_callback(url, event, state, file_size):
+            if event == omni.usd_resolver.Event.RESOLVING and state == omni.usd_resolver.EventState.STARTED:
+                resolves.append(url)
+
+        omni.usd_resolver.set_search_path_cache_ttl(60)
+        try:
+            resolver = Ar.GetResolver()
+            with omni.usd_resolver.register_event_callback(event_callback):
+                # The failed "look here first" probe should only be made once
+                self.assertEqual(resolver.CreateIdentifier(search_path, anchor), search_path)
+                self.assertEqual(resolver.CreateIdentifier(search_path, anchor), search_path)
+                self.assertEqual(resolves.count(anchored_url), 1)
+
+                # Writing the asset next to the anchor should invalidate the miss
+                layer = Sdf.Layer.CreateNew(anchored_url)
+                self.assertTrue(layer)
+                self.assertEqual(resolver.CreateIdentifier(search_path, anchor), anchored_url)
+        finally:
+            omni.usd_resolver.set_search_path_cache_ttl(0)
+
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_mdl_index(self):
+        root = f"{RANDOM_URL}/mdl_index/"
+        module = "vendor/library.mdl"
+        url = root + module
+
+        result = await omni.client.write_file_async(url, b"mdl 1.6;")
+        self.assertEqual(result, omni.client.Result.OK)
+
+        resolves = []
+
+        def event_callback(url, event, state, file_size):
+            if event == omni.usd_resolver.Event.RESOLVING and state == omni.usd_resolver.EventState.STARTED:
+                resolves.append(url)
+
+        omni.usd_resolver.index_mdl_search_roots([root])
+        try:
+            omni.usd_resolver.wait_for_mdl_index()
+            with omni.usd_resolver.register_event_callback(event_callback):
+                # An indexed module resolves without asking the server
+                self.assertEqual(Ar.GetResolver().Resolve(module), url)
+                self.assertEqual(resolves, [])
+        finally:
+            omni.usd_resolver.index_mdl_search_roots([])
+
+    @unittest.skipIf(DISABLE_ALL_ONLINE_TESTS, "")
+    @asyncio_wrap
+    async def test_prefetch(self):
+        urls = [f"{RANDOM_URL}/prefetch/layer_{i}.usda" for i in range(8)]
+        for i, url in enumerate(urls):
+            layer = Sdf.Layer.CreateNew(url)
+            layer.documentation = f"layer {i}"
+            self.assertTrue(layer.Save())
+
+        resolver = Ar.GetResolver()
+        resolved_paths = [resolver.Resolve(url).GetPathString() for url in urls]
+        omni.usd_resolver.prefetch(resolved_paths, priority=1)
+
+        # Opening a prefetched layer takes over its download, which is reported by the debug output on stderr
+        with tempfile.TemporaryFile(mode="w+") as capture:
+            sys.stderr.flush()
+            stderr_fd = os.dup(2)
+            os.dup2(capture.fileno(), 2)
+            Tf.Debug.SetOutputFile(sys.__stderr__)
+            Tf.Debug.SetDebugSymbolsByName("OMNI_USD_RESOLVER_ASSET", True)
+            try:
+                for i, url in enumerate(urls):
+                    layer = Sdf.Layer.OpenAsAnonymous(url)
+                    self.assertIsNotNone(layer)
+                    self.assertEqual(layer.documentation, f"layer {i}")
+            finally:
+                Tf.Debug.SetDebugSymbolsByName("OMNI_USD_RESOLVER_ASSET", False)
+                Tf.Debug.SetOutputFile(sys.__stdout__)
+                os.dup2(stderr_fd, 2)
+                os.close(stderr_fd)
+
+            capture.seek(0)
+            output = capture.read()
+
+        for resolved_path in resolved_paths:
+            self.assertIn(f"took over the download of {resolved_path}\n", output)
+
+        # Prefetching an asset that is never opened is harmless
+        omni.usd_resolver.prefetch(resolved_paths[:1])
+        omni.usd_resolver.flush_cache()
+
 
 def default_authorize_callback(prefix):
     return (TEST_USER, TEST_PASS)
@@ -29,12 +29,23 @@
 
 #include <OmniClient.h>
 #include <OmniUsdResolver.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
 #include <map>
+#include <mutex>
 #include <random>
 #include <thread>
 
+#ifdef __linux__
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
 /*
  * This contains a number of unit tests operating on NON live layers
  */
@@ -130,6 +141,49 @@ static bool VerifyRadius(std::string const& testFile, const double trueRadius)
     return VerifyRadius(layer, trueRadius);
 }
 
+// Counts the resolves that are started while it is alive, i.e the resolves that were not served by a cache
+class ScopedResolveCounter
+{
+public:
+    ScopedResolveCounter() : _id(omniUsdResolverRegisterEventCallback(&_resolves, &_OnEvent))
+    {
+    }
+
+    ~ScopedResolveCounter()
+    {
+        omniUsdResolverUnregisterCallback(_id);
+    }
+
+    ScopedResolveCounter(const ScopedResolveCounter&) = delete;
+    ScopedResolveCounter& operator=(const ScopedResolveCounter&) = delete;
+
+    size_t Get() const
+    {
+        return _resolves.load();
+    }
+
+    void Reset()
+    {
+        _resolves = 0;
+    }
+
+private:
+    static void _OnEvent(void* userData,
+                         const char* identifier,
+                         OmniUsdResolverEvent eventType,
+                         OmniUsdResolverEventState eventState,
+                         uint64_t fileSize) noexcept
+    {
+        if (eventType == eOmniUsdResolverEvent_Resolving && eventState == eOmniUsdResolverEventState_Started)
+        {
+            (*static_cast<std::atomic<size_t>*>(userData))++;
+        }
+    }
+
+    std::atomic<size_t> _resolves{ 0 };
+    const uint32_t _id;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 TEST(createLayer, "Simple test that just creates a layer")
@@ -1077,6 +1131,95 @@ TEST(openLayerAlias, "Export and open layers using equivalent URLs")
     return EXIT_SUCCESS;
 }
 
+TEST(resolveLayerAlias, "Resolving equivalent URLs should share a single cache entry")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const std::string url = layer->GetIdentifier();
+
+    // omni: instead of omniverse:, an upper-case host and a redundant "." segment
+    std::string alias = url;
+    alias.replace(0, strlen("omniverse:"), "omni:");
+    alias.replace(alias.find(test::host), test::host.size(), TfStringToUpper(test::host));
+    alias.insert(alias.rfind('/'), "/.");
+
+    ScopedResolveCounter resolves;
+
+    ArResolverScopedCache scopedCache;
+    ArResolver& resolver = ArGetResolver();
+
+    auto resolvedPath = resolver.Resolve(url);
+    auto aliasResolvedPath = resolver.Resolve(alias);
+    if (resolvedPath.empty() || resolvedPath != aliasResolvedPath)
+    {
+        testlog::printf("Expected %s and %s to resolve to the same path\n", url.c_str(), alias.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (resolves.Get() != 1)
+    {
+        testlog::printf("Expected %s to be resolved from the cache, got %zu resolves\n", alias.c_str(), resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(memoizeIdentifiers, "Identifiers created in a scoped cache are memoized until the anchored asset is written")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const ArResolvedPath anchor(layer->GetIdentifier());
+    const std::string searchPath = std::to_string(rand()) + ".usda";
+    const std::string anchoredUrl = test::randomUrl / searchPath;
+
+    ScopedResolveCounter resolves;
+
+    ArResolverScopedCache scopedCache;
+    ArResolver& resolver = ArGetResolver();
+
+    // Nothing lives next to the anchor yet so the search path is returned as-is
+    auto identifier = resolver.CreateIdentifier(searchPath, anchor);
+    const size_t expectedResolves = resolves.Get();
+    auto memoized = resolver.CreateIdentifier(searchPath, anchor);
+    if (identifier != searchPath || memoized != identifier)
+    {
+        testlog::printf("Expected %s for %s, got %s and %s\n", searchPath.c_str(), searchPath.c_str(),
+                        identifier.c_str(), memoized.c_str());
+        return EXIT_FAILURE;
+    }
+    if (resolves.Get() != expectedResolves)
+    {
+        testlog::printf("Expected the identifier for %s to be memoized, got %zu extra resolves\n", searchPath.c_str(),
+                        resolves.Get() - expectedResolves);
+        return EXIT_FAILURE;
+    }
+
+    // Writing the asset next to the anchor has to invalidate the memoized identifier
+    if (!SdfLayer::CreateNew(anchoredUrl))
+    {
+        testlog::printf("Failed to create %s\n", anchoredUrl.c_str());
+        return EXIT_FAILURE;
+    }
+
+    identifier = resolver.CreateIdentifier(searchPath, anchor);
+    if (identifier != anchoredUrl)
+    {
+        testlog::printf("Expected %s after writing it, got %s\n", anchoredUrl.c_str(), identifier.c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
 namespace test_memleak
 {
 // Create a simple box in USD with normals and UV information
@@ -1188,6 +1331,202 @@ static UsdGeomMesh createBox(UsdStageRefPtr stage, int boxNumber = 0)
 }
 } // namespace test_memleak
 
+TEST(bindContextPerThread, "Binding a resolver context should only affect the calling thread")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+
+    ArResolver& resolver = ArGetResolver();
+    const std::string baseUrl = safeString(omniClientGetBaseUrl());
+    const std::string fileName = TfGetBaseName(layer->GetIdentifier());
+
+    ArResolverContextBinder binder(resolver.CreateDefaultContextForAsset(layer->GetIdentifier()));
+
+    // The bound context must not leak into the base URL of client-library, which is shared by every thread
+    if (safeString(omniClientGetBaseUrl()) != baseUrl)
+    {
+        testlog::printf("Binding a context changed the client-library base URL to %s\n", omniClientGetBaseUrl());
+        return EXIT_FAILURE;
+    }
+
+    // Relative paths are still anchored to the bound context
+    auto resolvedPath = resolver.Resolve("./" + fileName);
+    if (resolvedPath.empty())
+    {
+        testlog::printf("Failed to resolve ./%s against the bound context\n", fileName.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const ArResolverContext boundContext = resolver.GetCurrentContext();
+    ArResolverContext otherContext;
+    std::thread([&]() { otherContext = resolver.GetCurrentContext(); }).join();
+    if (otherContext == boundContext)
+    {
+        testlog::printf("Context bound on one thread was visible on another: %s\n", otherContext.GetDebugString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(contextSearchPaths, "Search paths from a context string are resolved using listings of the search roots")
+{
+    const std::string missingRoot = test::randomUrl / "missing/";
+    const std::string libraryRoot = test::randomUrl / "library/";
+    const std::string fileName = std::to_string(rand()) + ".usda";
+    const std::string url = libraryRoot + fileName;
+    if (!SdfLayer::CreateNew(url))
+    {
+        testlog::printf("Failed to create %s\n", url.c_str());
+        return EXIT_FAILURE;
+    }
+
+    ArResolver& resolver = ArGetResolver();
+    const std::string contextStrs[] = {
+        missingRoot + ";" + libraryRoot,
+        TfStringPrintf(R"({"searchPaths": ["%s", "%s"]})", missingRoot.c_str(), libraryRoot.c_str()),
+    };
+
+    for (const auto& contextStr : contextStrs)
+    {
+        ScopedResolveCounter resolves;
+
+        ArResolverContextBinder binder(resolver.CreateContextFromString(contextStr));
+
+        auto resolvedPath = resolver.Resolve(fileName);
+        if (resolvedPath.GetPathString() != url)
+        {
+            testlog::printf("Expected %s to resolve to %s with context '%s', got '%s'\n", fileName.c_str(), url.c_str(),
+                            contextStr.c_str(), resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+
+        // The missing root is ruled out by its listing so only the library root is resolved
+        if (resolves.Get() != 1)
+        {
+            testlog::printf(
+                "Expected a single resolve with context '%s', got %zu\n", contextStr.c_str(), resolves.Get());
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(contextSearchPathsScopedCache, "Search paths resolved in one context are not shared with another by a scoped cache")
+{
+    const std::string fileName = std::to_string(rand()) + ".usda";
+    const std::string roots[] = { test::randomUrl / "rootA/", test::randomUrl / "rootB/" };
+    for (const auto& root : roots)
+    {
+        if (!SdfLayer::CreateNew(root + fileName))
+        {
+            testlog::printf("Failed to create %s\n", (root + fileName).c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    ArResolver& resolver = ArGetResolver();
+    ArResolverScopedCache scopedCache;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (const auto& root : roots)
+        {
+            ArResolverContextBinder binder(resolver.CreateContextFromString(root));
+
+            const std::string url = root + fileName;
+            auto resolvedPath = resolver.Resolve(fileName);
+            if (resolvedPath.GetPathString() != url)
+            {
+                testlog::printf("Expected %s to resolve to %s with search path %s, got '%s'\n", fileName.c_str(),
+                                url.c_str(), root.c_str(), resolvedPath.GetPathString().c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(globalCacheContexts, "Relative identifiers resolved in one context are not shared with another by the global cache")
+{
+    const std::string fileName = std::to_string(rand()) + ".usda";
+    const std::string urls[] = { test::randomUrl / "contextA" / fileName, test::randomUrl / "contextB" / fileName };
+    for (const auto& url : urls)
+    {
+        if (!SdfLayer::CreateNew(url))
+        {
+            testlog::printf("Failed to create %s\n", url.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    omniUsdResolverSetGlobalCacheEnabled(true);
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetGlobalCacheEnabled(false);
+    };
+
+    // Both a search path and a file-relative path resolve next to the asset of the bound context
+    ArResolver& resolver = ArGetResolver();
+    for (const std::string& assetPath : { fileName, "./" + fileName })
+    {
+        for (const auto& url : urls)
+        {
+            ArResolverContextBinder binder(resolver.CreateDefaultContextForAsset(url));
+
+            auto resolvedPath = resolver.Resolve(assetPath);
+            if (resolvedPath.GetPathString() != url)
+            {
+                testlog::printf("Expected %s to resolve to %s, got '%s'\n", assetPath.c_str(), url.c_str(),
+                                resolvedPath.GetPathString().c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(breakUrlView, "The non-allocating URL classifier should agree with omniClientBreakUrl")
+{
+    const char* urls[] = {
+        "/tmp/layer.usd",
+        "C:/projects/layer.USDA",
+        "omniverse://localhost/Projects/layer.usd",
+        "omniverse://localhost/Projects/layer.usd?checkpoint=3#frag",
+        "omni://localhost/Projects/.hidden",
+        "https://example.com:443/textures/albedo.png",
+        "file:/tmp/layer.usd",
+        "/tmp/with%20space.usd",
+        "layer.usd",
+        "./relative/layer.usd",
+    };
+
+    for (const char* url : urls)
+    {
+        std::string buffer;
+        const UrlView view = breakUrlView(url, buffer);
+        auto parsedUrl = parseUrl(url);
+
+        const std::string extension = TfGetExtension(safeString(parsedUrl->path));
+        if (view.local != isLocal(parsedUrl) || view.scheme != safeString(parsedUrl->scheme) ||
+            view.path != safeString(parsedUrl->path) || getExtension(view.path) != extension)
+        {
+            testlog::printf("Classified %s as scheme=%s path=%s local=%d, expected scheme=%s path=%s local=%d\n", url,
+                            std::string(view.scheme).c_str(), std::string(view.path).c_str(), view.local,
+                            safeString(parsedUrl->scheme).c_str(), safeString(parsedUrl->path).c_str(),
+                            isLocal(parsedUrl));
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
 TEST(memoryLeak, "Make sure there's not a memory leak when we free a layer")
 {
     size_t initialBytes = 0;
@@ -1817,6 +2156,988 @@ TEST(missingURLs, "Test URLs that can not be found return properly")
     return EXIT_SUCCESS;
 }
 
+TEST(streamingRead, "Test reading assets through a range reader while they are downloaded")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+    CreateSphere(layer);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(layer->GetIdentifier());
+
+    // Stands in for a server that supports ranged reads, serving the content read through the default asset
+    struct RangeServer
+    {
+        std::string content;
+        std::atomic<size_t> reads{ 0 };
+    } server;
+    {
+        auto asset = resolver.OpenAsset(resolvedPath);
+        if (!asset)
+        {
+            testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+        server.content.resize(asset->GetSize());
+        asset->Read(&server.content[0], server.content.size(), 0);
+    }
+
+    auto rangeRead = [](void* userData, const char* url, uint64_t offset, void* buffer, uint64_t count) noexcept
+    {
+        auto server = static_cast<RangeServer*>(userData);
+        server->reads++;
+        if (offset > server->content.size())
+        {
+            return int64_t(-1);
+        }
+        const uint64_t numRead = std::min<uint64_t>(count, server->content.size() - offset);
+        memcpy(buffer, server->content.data() + offset, numRead);
+        return int64_t(numRead);
+    };
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetRangeReader(nullptr, nullptr, 0);
+    };
+
+    // Assets smaller than the minimum size are downloaded before they are read
+    omniUsdResolverSetRangeReader(&server, rangeRead, server.content.size() + 1);
+    {
+        auto asset = resolver.OpenAsset(resolvedPath);
+        std::string content(asset ? asset->GetSize() : 0, '\0');
+        if (!asset || asset->Read(&content[0], content.size(), 0) != content.size() || content != server.content ||
+            server.reads != 0)
+        {
+            testlog::printf("Expected %s to be read from the local file\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Whether a read is served by the range reader or the local file depends on how quickly the download finishes,
+    // either way the content has to match
+    omniUsdResolverSetRangeReader(&server, rangeRead, 0);
+    auto asset = resolver.OpenAsset(resolvedPath);
+    if (!asset || asset->GetSize() != server.content.size())
+    {
+        testlog::printf("Failed to open %s for streaming\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string content(asset->GetSize(), '\0');
+    for (size_t offset = 0; offset < content.size(); offset += 7)
+    {
+        asset->Read(&content[offset], std::min<size_t>(7, content.size() - offset), offset);
+    }
+    if (content != server.content)
+    {
+        testlog::printf("Content read from %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto buffer = asset->GetBuffer();
+    if (!buffer || std::string(buffer.get(), asset->GetSize()) != server.content)
+    {
+        testlog::printf("Buffer of %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Once the download has finished the local file is available
+    if (!asset->GetFileUnsafe().first)
+    {
+        testlog::printf("Expected the local file of %s after GetBuffer\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(sharedLocalFile, "Test that assets for the same local file share the file and its mapping")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+    CreateSphere(layer);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(layer->GetIdentifier());
+
+    auto assetA = resolver.OpenAsset(resolvedPath);
+    auto assetB = resolver.OpenAsset(resolvedPath);
+    if (!assetA || !assetB)
+    {
+        testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (assetA->GetFileUnsafe().first != assetB->GetFileUnsafe().first)
+    {
+        testlog::printf("Expected both assets for %s to share the local file\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto bufferA = assetA->GetBuffer();
+    auto bufferB = assetB->GetBuffer();
+    if (!bufferA || bufferA.get() != bufferB.get() || bufferA.get() != assetA->GetBuffer().get())
+    {
+        testlog::printf("Expected every buffer for %s to share a mapping\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // The buffer stays valid after the assets are gone
+    const std::string content(bufferA.get(), assetA->GetSize());
+    const size_t size = assetA->GetSize();
+    assetA.reset();
+    assetB.reset();
+    if (std::string(bufferA.get(), size) != content)
+    {
+        testlog::printf("Buffer for %s changed after its assets were destroyed\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(readAhead, "Test that small sequential and random reads return the same content as a single read")
+{
+    omniUsdResolverSetReadAheadSize(1024 * 1024);
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetReadAheadSize(0);
+    };
+
+    // Crate files are never read ahead, so the layer is written as text
+    const std::string url = test::randomUrl / (std::to_string(rand()) + ".usda");
+    auto layer = SdfLayer::CreateNew(url);
+    if (!layer)
+    {
+        testlog::printf("Failed to create %s\n", url.c_str());
+        return EXIT_FAILURE;
+    }
+    CreateSphere(layer);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(layer->GetIdentifier());
+    auto asset = resolver.OpenAsset(resolvedPath);
+    if (!asset)
+    {
+        testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string expected(asset->GetSize(), '\0');
+    if (asset->Read(&expected[0], expected.size(), 0) != expected.size())
+    {
+        testlog::printf("Failed to read %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Sequential reads switch to reading ahead after the first few reads
+    std::string sequential(expected.size(), '\0');
+    for (size_t offset = 0; offset < sequential.size(); offset += 5)
+    {
+        asset->Read(&sequential[offset], std::min<size_t>(5, sequential.size() - offset), offset);
+    }
+
+    // Reading backwards never continues where the previous read ended
+    std::string backwards(expected.size(), '\0');
+    for (size_t end = backwards.size(); end > 0;)
+    {
+        const size_t offset = end > 3 ? end - 3 : 0;
+        asset->Read(&backwards[offset], end - offset, offset);
+        end = offset;
+    }
+
+    if (sequential != expected || backwards != expected)
+    {
+        testlog::printf("Small reads of %s do not match a single read\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Threads reading the same asset sequentially keep resetting each other's detection and refilling the buffer
+    constexpr size_t kNumThreads = 4;
+    std::vector<std::string> concurrent(kNumThreads, std::string(expected.size(), '\0'));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kNumThreads; ++i)
+    {
+        threads.emplace_back(
+            [&asset, &read = concurrent[i], step = i + 2]()
+            {
+                for (size_t offset = 0; offset < read.size(); offset += step)
+                {
+                    asset->Read(&read[offset], std::min(step, read.size() - offset), offset);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    if (static_cast<size_t>(std::count(concurrent.begin(), concurrent.end(), expected)) != kNumThreads)
+    {
+        testlog::printf("Concurrent small reads of %s do not match a single read\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Reads past the end return what is left of the asset
+    char tail[16];
+    if (asset->Read(tail, sizeof(tail), expected.size() - 1) != 1 || tail[0] != expected.back())
+    {
+        testlog::printf("Expected a short read at the end of %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(inMemoryAsset, "Test that small assets are read into memory when they are opened")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+    CreateSphere(layer);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(layer->GetIdentifier());
+
+    std::string expected;
+    {
+        auto asset = resolver.OpenAsset(resolvedPath);
+        if (!asset || !asset->GetFileUnsafe().first)
+        {
+            testlog::printf("Expected %s to be read from the local file\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+        expected.resize(asset->GetSize());
+        asset->Read(&expected[0], expected.size(), 0);
+    }
+
+    omniUsdResolverSetInMemoryAssetSize(expected.size() + 1);
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetInMemoryAssetSize(0);
+    };
+
+    auto asset = resolver.OpenAsset(resolvedPath);
+    if (!asset || asset->GetSize() != expected.size())
+    {
+        testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (asset->GetFileUnsafe().first)
+    {
+        testlog::printf("Expected %s to be read into memory\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto buffer = asset->GetBuffer();
+    if (!buffer || buffer.get() != asset->GetBuffer().get() || std::string(buffer.get(), expected.size()) != expected)
+    {
+        testlog::printf("Expected the in-memory buffer of %s to be returned\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string content(expected.size(), '\0');
+    if (asset->Read(&content[0], content.size() + 16, 0) != expected.size() || content != expected)
+    {
+        testlog::printf("Content read from %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(ioUring, "Test that reads split into ranges for io_uring return the same content as pread")
+{
+    // The layer needs to be several MiB for large reads to be split into ranges
+    const std::string url = test::randomUrl / (std::to_string(rand()) + ".usda");
+    auto layer = SdfLayer::CreateNew(url);
+    if (!layer)
+    {
+        testlog::printf("Failed to create %s\n", url.c_str());
+        return EXIT_FAILURE;
+    }
+    auto prim = SdfPrimSpec::New(layer->GetPseudoRoot(), "values", SdfSpecifierDef);
+    auto attr = SdfAttributeSpec::New(prim, "values", SdfValueTypeNames->IntArray);
+    VtArray<int> values(500000);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i * 7919);
+    }
+    layer->SetField(attr->GetPath(), SdfFieldKeys->Default, VtValue(values));
+    layer->Save();
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(url);
+    auto asset = resolver.OpenAsset(resolvedPath);
+    if (!asset)
+    {
+        testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string expected(asset->GetSize(), '\0');
+    if (asset->Read(&expected[0], expected.size(), 0) != expected.size())
+    {
+        testlog::printf("Failed to read %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Reads fall back to pread if io_uring is not available, so the content has to match either way
+    omniUsdResolverSetIoUringEnabled(true);
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetIoUringEnabled(false);
+    };
+
+    // Every thread reads the whole asset in large reads, which are split into ranges, and in small reads, which
+    // are not. Each read past the end only returns what is left of the asset
+    constexpr size_t kNumThreads = 8;
+    std::vector<std::string> large(kNumThreads, std::string(expected.size(), '\0'));
+    std::vector<std::string> small(kNumThreads, std::string(expected.size(), '\0'));
+    std::atomic<size_t> shortReads{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kNumThreads; ++i)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                const size_t largeSize = (i + 2) * 1024 * 1024 + i;
+                for (size_t offset = 0; offset < expected.size(); offset += largeSize)
+                {
+                    const size_t count = std::min(largeSize, expected.size() - offset);
+                    if (asset->Read(&large[i][offset], largeSize, offset) != count)
+                    {
+                        shortReads++;
+                    }
+                }
+
+                const size_t smallSize = 4096 + i;
+                for (size_t offset = 0; offset < expected.size(); offset += smallSize)
+                {
+                    const size_t count = std::min(smallSize, expected.size() - offset);
+                    if (asset->Read(&small[i][offset], count, offset) != count)
+                    {
+                        shortReads++;
+                    }
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (shortReads != 0)
+    {
+        testlog::printf("Expected every read of %s to return all of the requested bytes that exist, %zu did not\n",
+                        resolvedPath.GetPathString().c_str(), shortReads.load());
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < kNumThreads; ++i)
+    {
+        if (large[i] != expected || small[i] != expected)
+        {
+            testlog::printf("Reads of %s with io_uring do not match pread\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(packageIndex, "Test that files inside of remote USDZ packages are read without copying the package")
+{
+    char const* filename = "Skull_downloadable.usdz";
+
+    std::string localResolved;
+    omniClientWait(omniClientResolve(
+        filename, nullptr, 0, &localResolved,
+        [](void* userData, OmniClientResult result, struct OmniClientListEntry const* entry, char const* url) noexcept
+        {
+            if (result == eOmniClientResult_Ok)
+            {
+                *(std::string*)userData = safeString(url);
+            }
+        }));
+    if (localResolved.empty())
+    {
+        testlog::printf("Could not resolve %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    std::string sceneStr = test::randomUrl / "packageIndex" / filename;
+    omniClientWait(omniClientCopy(localResolved.c_str(), sceneStr.c_str(), {}, {}));
+
+    UsdStageRefPtr stage = UsdStage::Open(sceneStr);
+    if (!stage)
+    {
+        testlog::printf("Unable to open stage %s\n", sceneStr.c_str());
+        return EXIT_FAILURE;
+    }
+
+    UsdShadeShader texBase = UsdShadeShader::Get(stage, SdfPath("/scene/Materials/defaultMat/tex_base"));
+    if (!texBase)
+    {
+        testlog::printf("Unable to get tex_base Shader\n");
+        return EXIT_FAILURE;
+    }
+
+    SdfAssetPath assetPath;
+    texBase.GetInput(TfToken("file")).GetAttr().Get(&assetPath);
+    const std::string resolvedPath = assetPath.GetResolvedPath();
+    if (!ArIsPackageRelativePath(resolvedPath))
+    {
+        testlog::printf("%s is not a package relative path\n", resolvedPath.c_str());
+        return EXIT_FAILURE;
+    }
+    const std::string packagePath = ArSplitPackageRelativePathOuter(resolvedPath).first;
+
+    // Usd opens the package again for every file inside of it, which should share the same asset
+    auto& underlyingResolver = ArGetUnderlyingResolver();
+    auto package = underlyingResolver.OpenAsset(ArResolvedPath(packagePath));
+    if (!package || package != underlyingResolver.OpenAsset(ArResolvedPath(packagePath)))
+    {
+        testlog::printf("Opening %s twice did not return the same asset\n", packagePath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto expected = ArGetResolver().OpenAsset(ArResolvedPath(resolvedPath));
+    auto packaged = underlyingResolver.OpenAsset(ArResolvedPath(resolvedPath));
+    if (!expected || !packaged)
+    {
+        testlog::printf("Unable to open %s\n", resolvedPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto expectedBuffer = expected->GetBuffer();
+    auto packagedBuffer = packaged->GetBuffer();
+    if (!expectedBuffer || !packagedBuffer || expected->GetSize() != packaged->GetSize() ||
+        memcmp(expectedBuffer.get(), packagedBuffer.get(), packaged->GetSize()) != 0)
+    {
+        testlog::printf("Packaged asset %s does not match the package resolver\n", resolvedPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<char> data(packaged->GetSize());
+    if (packaged->Read(data.data(), data.size(), 0) != data.size() ||
+        memcmp(data.data(), packagedBuffer.get(), data.size()) != 0)
+    {
+        testlog::printf("Unable to read packaged asset %s\n", resolvedPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // The packaged asset is a view into the package rather than a copy of it
+    auto packageBuffer = package->GetBuffer();
+    if (!packageBuffer || packagedBuffer.get() < packageBuffer.get() ||
+        packagedBuffer.get() + packaged->GetSize() > packageBuffer.get() + package->GetSize())
+    {
+        testlog::printf("Packaged asset %s was copied out of the package\n", resolvedPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (underlyingResolver.OpenAsset(ArResolvedPath(ArJoinPackageRelativePath(packagePath, "missing.png"))))
+    {
+        testlog::printf("Opened a file that is not in package %s\n", packagePath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(streamingUpload, "Test uploading assets through an upload sink while they are written")
+{
+    // Stands in for a server that supports chunked uploads, keeping the uploaded content in memory
+    struct UploadServer
+    {
+        std::mutex mutex;
+        std::string content;
+        std::atomic<size_t> chunks{ 0 };
+        bool failChunks = false;
+        bool committed = false;
+        bool aborted = false;
+    } server;
+
+    OmniUsdResolverUploadSink sink = {};
+    sink.userData = &server;
+    sink.begin = [](void* userData, const char* url) noexcept -> void* { return userData; };
+    sink.chunk = [](void* userData, void* upload, uint64_t offset, const void* buffer, uint64_t count) noexcept
+    {
+        auto server = static_cast<UploadServer*>(upload);
+        if (server->failChunks)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(server->mutex);
+        if (server->content.size() < offset + count)
+        {
+            server->content.resize(offset + count);
+        }
+        memcpy(&server->content[offset], buffer, count);
+        server->chunks++;
+        return true;
+    };
+    sink.commit = [](void* userData, void* upload, uint64_t size, const char* message) noexcept
+    {
+        auto server = static_cast<UploadServer*>(upload);
+        std::lock_guard<std::mutex> lock(server->mutex);
+        server->content.resize(size);
+        server->committed = true;
+        return true;
+    };
+    sink.abort = [](void* userData, void* upload) noexcept { static_cast<UploadServer*>(upload)->aborted = true; };
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetUploadSink(nullptr, 0);
+    };
+
+    constexpr size_t kChunkSize = 64 * 1024;
+    omniUsdResolverSetUploadSink(&sink, kChunkSize);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.ResolveForNewAsset(test::randomUrl / "streamingUpload.dat");
+
+    std::string expected(16 * kChunkSize + 123, '\0');
+    std::mt19937 random(1234);
+    std::generate(expected.begin(), expected.end(), [&random]() { return static_cast<char>(random()); });
+
+    auto writeContent = [&](ArWritableAsset& asset)
+    {
+        // Like usdc, leave room for a header that is written last
+        constexpr size_t kHeaderSize = 88;
+        for (size_t offset = kHeaderSize; offset < expected.size(); offset += 1000)
+        {
+            const size_t count = std::min<size_t>(1000, expected.size() - offset);
+            if (asset.Write(&expected[offset], count, offset) != count)
+            {
+                return false;
+            }
+        }
+
+        // Chunks are uploaded in the background while the asset is written
+        for (int i = 0; i < 500 && server.chunks == 0 && !server.failChunks; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        return asset.Write(&expected[0], kHeaderSize, 0) == kHeaderSize;
+    };
+
+    {
+        auto asset = resolver.OpenAssetForWrite(resolvedPath, ArResolver::WriteMode::Replace);
+        if (!asset || !writeContent(*asset))
+        {
+            testlog::printf("Failed to write %s\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+        if (server.chunks == 0)
+        {
+            testlog::printf("No chunks of %s were uploaded before it was closed\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+        if (!asset->Close())
+        {
+            testlog::printf("Failed to close %s\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!server.committed || server.aborted || server.content != expected)
+    {
+        testlog::printf("Uploaded content of %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // If the upload fails the temporary file is moved to the server instead
+    server.failChunks = true;
+    server.committed = false;
+    {
+        auto asset = resolver.OpenAssetForWrite(resolvedPath, ArResolver::WriteMode::Replace);
+        if (!asset || !writeContent(*asset) || !asset->Close())
+        {
+            testlog::printf("Failed to write %s after the upload failed\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (server.committed || !server.aborted)
+    {
+        testlog::printf("Expected the upload of %s to be aborted\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto asset = resolver.OpenAsset(resolver.Resolve(resolvedPath.GetPathString()));
+    std::string content(asset ? asset->GetSize() : 0, '\0');
+    if (!asset || asset->Read(&content[0], content.size(), 0) != content.size() || content != expected)
+    {
+        testlog::printf("Content moved to %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#ifdef __linux__
+// Captures what TF_DEBUG writes for a debug code while it is alive. TfDebug only writes to stdout or stderr, so stderr
+// is redirected to a temporary file. TfDebug writes to stdout again afterwards, which is its default
+class ScopedDebugCapture
+{
+public:
+    explicit ScopedDebugCapture(const char* debugCode)
+        : _debugCode(debugCode), _path(ArchMakeTmpFileName("omni-usd-resolver-debug", ".log"))
+    {
+        fflush(stderr);
+        _stderrFd = dup(STDERR_FILENO);
+        const int fd = open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+        TfDebug::SetOutputFile(stderr);
+        TfDebug::SetDebugSymbolsByName(_debugCode, true);
+    }
+
+    ~ScopedDebugCapture()
+    {
+        Finish();
+        ArchUnlinkFile(_path.c_str());
+    }
+
+    /// Stops capturing and returns everything that was written
+    std::string Finish()
+    {
+        if (_stderrFd >= 0)
+        {
+            TfDebug::SetDebugSymbolsByName(_debugCode, false);
+            TfDebug::SetOutputFile(stdout);
+            fflush(stderr);
+            dup2(_stderrFd, STDERR_FILENO);
+            close(_stderrFd);
+            _stderrFd = -1;
+        }
+
+        std::string output;
+        if (FILE* file = ArchOpenFile(_path.c_str(), "rb"))
+        {
+            char buffer[4096];
+            size_t numRead;
+            while ((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            {
+                output.append(buffer, numRead);
+            }
+            fclose(file);
+        }
+        return output;
+    }
+
+private:
+    const std::string _debugCode;
+    const std::string _path;
+    int _stderrFd = -1;
+};
+#endif
+
+TEST(updateAsset, "Test that updating an asset starts from its content without changing the cached local file")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+    CreateSphere(layer);
+
+    ArResolver& resolver = ArGetResolver();
+    auto resolvedPath = resolver.Resolve(layer->GetIdentifier());
+
+    // The buffer maps the cached local file that the updated file is cloned from
+    auto original = resolver.OpenAsset(resolvedPath);
+    auto originalBuffer = original ? original->GetBuffer() : nullptr;
+    if (!originalBuffer)
+    {
+        testlog::printf("Failed to open %s\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+    const std::string originalContent(originalBuffer.get(), original->GetSize());
+
+    const std::string appended = "\n# updated\n";
+    {
+#ifdef __linux__
+        ScopedDebugCapture capture("OMNI_USD_RESOLVER_ASSET");
+#endif
+        auto asset = resolver.OpenAssetForWrite(resolvedPath, ArResolver::WriteMode::Update);
+        if (!asset || asset->Write(appended.data(), appended.size(), originalContent.size()) != appended.size() ||
+            !asset->Close())
+        {
+            testlog::printf("Failed to update %s\n", resolvedPath.GetPathString().c_str());
+            return EXIT_FAILURE;
+        }
+
+#ifdef __linux__
+        // The local file is cached since it was opened above, so it is cloned instead of copied on the server. Cloning
+        // can only fail when the cache and the temporary directory are on different filesystems
+        const std::string output = capture.Finish();
+        const bool cloned = output.find(": cloned") != std::string::npos;
+        struct stat cachedStat, tmpStat;
+        FILE* cachedFile = original->GetFileUnsafe().first;
+        const bool sameFilesystem = cachedFile && fstat(fileno(cachedFile), &cachedStat) == 0 &&
+                                    stat(ArchGetTmpDir(), &tmpStat) == 0 && cachedStat.st_dev == tmpStat.st_dev;
+        if (!cloned && (sameFilesystem || output.find(": failed") == std::string::npos))
+        {
+            testlog::printf("Expected the cached local file of %s to be cloned:\n%s\n",
+                            resolvedPath.GetPathString().c_str(), output.c_str());
+            return EXIT_FAILURE;
+        }
+#endif
+    }
+
+    if (std::string(originalBuffer.get(), originalContent.size()) != originalContent)
+    {
+        testlog::printf("Updating %s changed its cached local file\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto updated = resolver.OpenAsset(resolver.Resolve(layer->GetIdentifier()));
+    std::string content(updated ? updated->GetSize() : 0, '\0');
+    if (!updated || updated->Read(&content[0], content.size(), 0) != content.size() ||
+        content != originalContent + appended)
+    {
+        testlog::printf("Updated content of %s does not match\n", resolvedPath.GetPathString().c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(resolveIndex, "Test that resolves saved to the resolve index are trusted by a fresh index until they are stale")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const std::string url = layer->GetIdentifier();
+    const std::string indexPath = ArchMakeTmpFileName("omni-usd-resolver-index", ".idx");
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverSetResolveIndex(nullptr, 0);
+        ArchUnlinkFile(indexPath.c_str());
+    };
+
+    ScopedResolveCounter resolves;
+
+    ArResolver& resolver = ArGetResolver();
+
+    omniUsdResolverSetResolveIndex(indexPath.c_str(), 600);
+    const auto resolvedPath = resolver.Resolve(url);
+    if (resolvedPath.empty() || resolves.Get() != 1 || !omniUsdResolverSaveResolveIndex())
+    {
+        testlog::printf("Failed to save the resolve of %s to %s\n", url.c_str(), indexPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Switching to the same file drops everything in memory, so the resolve can only come from the file
+    omniUsdResolverSetResolveIndex(indexPath.c_str(), 600);
+    resolves.Reset();
+    if (resolver.Resolve(url) != resolvedPath || resolves.Get() != 0)
+    {
+        testlog::printf("Expected %s to be found in %s, got %zu resolves\n", url.c_str(), indexPath.c_str(),
+                        resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    // Entries that were resolved longer ago than the staleness are resolved again
+    omniUsdResolverSetResolveIndex(indexPath.c_str(), 0);
+    resolves.Reset();
+    if (resolver.Resolve(url) != resolvedPath || resolves.Get() != 1)
+    {
+        testlog::printf("Expected the stale entry for %s to be resolved again, got %zu resolves\n", url.c_str(),
+                        resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(resolveBatch, "Test resolving a batch of identifiers and warming the scoped cache")
+{
+    auto layerA = CreateTestLayer();
+    auto layerB = CreateTestLayer();
+    if (!layerA || !layerB)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::string missingUrl = test::randomUrl / "batch_missing.usda";
+    std::vector<const char*> identifiers = { layerA->GetIdentifier().c_str(), layerB->GetIdentifier().c_str(),
+                                             missingUrl.c_str(), layerA->GetIdentifier().c_str() };
+
+    struct Context
+    {
+        std::vector<std::string> resolvedPaths;
+        std::vector<uint64_t> sizes;
+    } context;
+
+    ScopedResolveCounter resolves;
+    ArResolverScopedCache scopedCache;
+
+    auto batchCallback = [](void* userData, const OmniUsdResolverResolveResult* results, size_t count) noexcept
+    {
+        auto& context = *static_cast<Context*>(userData);
+        context.resolvedPaths.clear();
+        context.sizes.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            context.resolvedPaths.push_back(results[i].resolvedPath);
+            context.sizes.push_back(results[i].size);
+        }
+    };
+    omniUsdResolverResolveBatch(identifiers.data(), identifiers.size(), &context, batchCallback);
+
+    if (context.resolvedPaths.size() != identifiers.size())
+    {
+        testlog::printf("Expected %zu results, got %zu\n", identifiers.size(), context.resolvedPaths.size());
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i : { 0, 1, 3 })
+    {
+        if (context.resolvedPaths[i].empty() || context.sizes[i] == 0)
+        {
+            testlog::printf("Failed to resolve %s in batch\n", identifiers[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!context.resolvedPaths[2].empty())
+    {
+        testlog::printf("Invalid result for %s. Expected empty string\n", missingUrl.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // The duplicate identifier should only be resolved once
+    if (resolves.Get() != 3)
+    {
+        testlog::printf("Expected 3 resolves for the batch, got %zu\n", resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    // Everything in the batch, including the failed resolve, should now be served from the scoped cache
+    ArResolver& resolver = ArGetResolver();
+    if (resolver.Resolve(layerA->GetIdentifier()).GetPathString() != context.resolvedPaths[0] ||
+        resolver.Resolve(layerB->GetIdentifier()).GetPathString() != context.resolvedPaths[1] ||
+        !resolver.Resolve(missingUrl).empty())
+    {
+        testlog::print("Resolve did not match the batch results\n");
+        return EXIT_FAILURE;
+    }
+
+    if (resolves.Get() != 3)
+    {
+        testlog::printf("Expected resolves to be cached, got %zu resolves\n", resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+TEST(coalesceResolves, "Test that concurrent resolves of the same identifier share a single request")
+{
+    auto layer = CreateTestLayer();
+    if (!layer)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const std::string identifier = layer->GetIdentifier();
+
+    constexpr size_t kNumThreads = 16;
+    struct Gate
+    {
+        std::mutex mutex;
+        std::condition_variable started;
+        size_t numStarted = 0;
+        bool holding = false;
+    } gate;
+
+    // The first thread to resolve is held inside of its resolve until every other thread has started resolving, so
+    // they all arrive while it is in flight. Nothing else caches the resolve, so each thread that did not wait for it
+    // would resolve on its own
+    auto gateId = omniUsdResolverRegisterEventCallback(
+        &gate,
+        [](void* userData, const char* identifier, OmniUsdResolverEvent eventType,
+           OmniUsdResolverEventState eventState, uint64_t fileSize) noexcept
+        {
+            if (eventType != eOmniUsdResolverEvent_Resolving || eventState != eOmniUsdResolverEventState_Started)
+            {
+                return;
+            }
+
+            auto& gate = *static_cast<Gate*>(userData);
+            std::unique_lock<std::mutex> lock(gate.mutex);
+            if (gate.holding)
+            {
+                return;
+            }
+            gate.holding = true;
+            gate.started.wait(lock, [&gate] { return gate.numStarted == kNumThreads; });
+            lock.unlock();
+
+            // Give the other threads time to get from Resolve to waiting on the resolve in flight
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        });
+    CARB_SCOPE_EXIT
+    {
+        omniUsdResolverUnregisterCallback(gateId);
+    };
+
+    ScopedResolveCounter resolves;
+
+    std::atomic<size_t> failures{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kNumThreads; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(gate.mutex);
+                    gate.numStarted++;
+                }
+                gate.started.notify_all();
+
+                if (ArGetResolver().Resolve(identifier).empty())
+                {
+                    failures++;
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (failures != 0)
+    {
+        testlog::printf("Failed to resolve %s on %zu threads\n", identifier.c_str(), failures.load());
+        return EXIT_FAILURE;
+    }
+
+    if (resolves.Get() != 1)
+    {
+        testlog::printf("Expected concurrent resolves to share a single resolve, got %zu resolves\n", resolves.Get());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
 TEST(overwriteUrls, "Test that URLs are properly overwritten")
 {
     std::string testUrl = GenerateTestUrl();
@@ -12,6 +12,12 @@
 
 #include <OmniClient.h>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
 namespace std
 {
 template <>
@@ -97,3 +103,116 @@ inline bool isOmniverse(std::unique_ptr<OmniClientUrl> const& url)
 {
     return url->scheme && (strncmp(url->scheme, "omni", 4) == 0);
 }
+
+/// \brief The parts of a URL that hot paths care about
+///
+/// The views point into the URL that was broken, or into the buffer passed to breakUrlView when client-library
+/// had to be used, so they must not outlive either.
+struct UrlView
+{
+    std::string_view scheme;
+    std::string_view path;
+    bool local = false;
+};
+
+/// \brief Breaks \p url apart without allocating for the common cases
+///
+/// Absolute local paths and URLs with a simple path are classified in place. Anything that requires decoding
+/// or is otherwise ambiguous, such as relative paths, file: URLs, UNC paths or percent-encoded paths, is handed
+/// to omniClientBreakUrl and the parts are copied into \p buffer.
+inline UrlView breakUrlView(std::string_view url, std::string& buffer)
+{
+    UrlView view;
+
+    auto isAlpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+    auto isSchemeChar = [&isAlpha](char c)
+    { return isAlpha(c) || (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.'; };
+
+    size_t colon = 0;
+    while (colon < url.size() && isSchemeChar(url[colon]))
+    {
+        ++colon;
+    }
+
+    bool simple = false;
+    if (!url.empty() && url[0] == '/' && (url.size() == 1 || url[1] != '/'))
+    {
+        // An absolute POSIX path
+        view.local = true;
+        view.path = url;
+        simple = true;
+    }
+    else if (url.size() > 2 && isAlpha(url[0]) && url[1] == ':' && (url[2] == '/' || url[2] == '\\'))
+    {
+        // A Windows path with a drive letter, which client-library treats as a raw path
+        view.local = true;
+        view.path = url;
+        simple = true;
+    }
+    else if (colon >= 2 && colon < url.size() && url[colon] == ':' && isAlpha(url[0]))
+    {
+        view.scheme = url.substr(0, colon);
+
+        // file: URLs may need their host or drive letter handled, leave those to client-library
+        static constexpr std::string_view kFile{ "file" };
+        const bool isFile = view.scheme.size() == kFile.size() &&
+                            std::equal(kFile.begin(), kFile.end(), view.scheme.begin(),
+                                       [](char a, char b) { return a == (b | 0x20); });
+
+        std::string_view rest = url.substr(colon + 1);
+        if (rest.size() >= 2 && rest[0] == '/' && rest[1] == '/')
+        {
+            rest = rest.substr(std::min(rest.find_first_of("/?#", 2), rest.size()));
+        }
+        view.path = rest.substr(0, rest.find_first_of("?#"));
+        simple = !isFile;
+    }
+
+    if (simple && view.path.find_first_of(view.local ? "%?#" : "%\\") == std::string_view::npos)
+    {
+        return view;
+    }
+
+    auto parsedUrl = std::unique_ptr<OmniClientUrl>(omniClientBreakUrl(std::string(url).c_str()));
+
+    const size_t schemeSize = parsedUrl->scheme ? strlen(parsedUrl->scheme) : 0;
+    buffer.assign(parsedUrl->scheme ? parsedUrl->scheme : "");
+    buffer.append(parsedUrl->path ? parsedUrl->path : "");
+
+    view.scheme = std::string_view(buffer).substr(0, schemeSize);
+    view.path = std::string_view(buffer).substr(schemeSize);
+    view.local = isLocal(parsedUrl);
+    return view;
+}
+
+/// \brief Returns true if \p url refers to a local file
+inline bool isLocal(std::string_view url)
+{
+    std::string buffer;
+    return breakUrlView(url, buffer).local;
+}
+
+/// \brief Returns true if \p url uses one of the omniverse schemes
+inline bool isOmniverse(std::string_view url)
+{
+    std::string buffer;
+    const UrlView view = breakUrlView(url, buffer);
+    return view.scheme.size() >= 4 && view.scheme.compare(0, 4, "omni") == 0;
+}
+
+/// \brief Returns the extension of the last component of \p path, without the leading dot
+///
+/// This matches TfGetExtension: dot-files and paths without an extension return an empty view
+inline std::string_view getExtension(std::string_view path)
+{
+    const size_t slash = path.find_last_of("/\\");
+    const std::string_view fileName = slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+    const size_t dot = fileName.rfind('.');
+    if (dot == std::string_view::npos || dot == 0)
+    {
+        return {};
+    }
+
+    return fileName.substr(dot + 1);
+}
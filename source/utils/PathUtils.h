@@ -13,8 +13,9 @@
 #include "StringUtils.h"
 
 #include <string>
+#include <string_view>
 
-inline bool isRelativePath(std::string const& path)
+inline bool isRelativePath(std::string_view path)
 {
     // Absolute paths either have a colon before a slash (indicating urls or drive letters in windows)
     // or they start with a '/' (indicating absolute paths in linux or UNC prefix on windows
@@ -34,7 +35,7 @@ inline bool isRelativePath(std::string const& path)
     return true;
 }
 
-inline bool isFileRelative(std::string const& path)
+inline bool isFileRelative(std::string_view path)
 {
     return path.compare(0, 2, "./") == 0 || path.compare(0, 3, "../") == 0 || path.compare(0, 2, ".\\") == 0 ||
            path.compare(0, 3, "..\\") == 0;
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: LicenseRef-NvidiaProprietary
+//
+// NVIDIA CORPORATION, its affiliates and licensors retain all intellectual
+// property and proprietary rights in and to this material, related
+// documentation and any modifications thereto. Any use, reproduction,
+// disclosure or distribution of this material and related documentation
+// without an express license agreement from NVIDIA CORPORATION or
+// its affiliates is strictly prohibited.
+
+#pragma once
+
+#include "PythonUtils.h"
+
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+/// \brief Coalesces concurrent calls for the same key so that only one of them does the work.
+///
+/// The first thread to call Do for a key runs the function while any other thread calling Do for the same key
+/// waits for, and shares, its result. Once the function returns the key is forgotten, so the next call runs
+/// the function again. Callers are expected to cache the result inside the function if it should be reused.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight
+{
+public:
+    /// \brief Runs \p fn for \p key unless another thread is already running it
+    /// \param key the key identifying the work
+    /// \param fn the work to run. Any exception thrown is rethrown in every waiting thread
+    /// \param[out] shared set to true if the result came from another thread
+    /// \returns the result of \p fn
+    template <typename Fn>
+    Value Do(const Key& key, Fn&& fn, bool* shared = nullptr)
+    {
+        std::promise<Value> promise;
+        std::shared_future<Value> future;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_inflight.find(key);
+            if (it != m_inflight.end())
+            {
+                future = it->second;
+            }
+            else
+            {
+                m_inflight.emplace(key, promise.get_future().share());
+            }
+        }
+
+        if (shared)
+        {
+            *shared = future.valid();
+        }
+
+        if (future.valid())
+        {
+            {
+                // The thread doing the work might need the GIL
+                PyReleaseGil g;
+                future.wait();
+            }
+            return future.get();
+        }
+
+        try
+        {
+            Value value = fn();
+            _Forget(key);
+            promise.set_value(value);
+            return value;
+        }
+        catch (...)
+        {
+            _Forget(key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+private:
+    void _Forget(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inflight.erase(key);
+    }
+
+    std::mutex m_mutex;
+    std::unordered_map<Key, std::shared_future<Value>, Hash> m_inflight;
+};